@@ -0,0 +1,110 @@
+#include "Convolution.hpp"
+#include "ImageUtils.hpp"
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+#include "opencv2/core/utility.hpp" // cần hàm cv::parallel_for_
+
+RowConvolver::RowConvolver(const cv::Mat& kern) {
+    if (kern.type() != CV_64FC1 || kern.rows != kern.cols || kern.rows < 1) {
+        throw std::runtime_error("Anh hoac kernel khong hop le cho phep chap");
+    }
+
+    // lật kernel một lần để vòng lặp trong duyệt cả ảnh và kernel theo cùng chiều:
+    // w[i * k + j] nhân với pixel (x + i - r, y + j - r)
+    k = kern.rows;
+    r = (k - 1) / 2;
+    w.resize(k * k);
+    for (int i = 0; i < k; ++i) {
+        for (int j = 0; j < k; ++j) {
+            w[i * k + j] = kern.at<double>(k - 1 - i, k - 1 - j);
+        }
+    }
+}
+
+void RowConvolver::apply(const uchar* const* rows, int cols, int cn, uchar* out) const {
+    applyRow(rows, cols, cn, out);
+}
+
+void RowConvolver::apply(const uchar* const* rows, int cols, int cn, double* out) const {
+    applyRow(rows, cols, cn, out);
+}
+
+/**
+ * phần thân của apply: mỗi dòng chia thành 2 đoạn biên cần cắt cửa sổ theo ảnh và đoạn giữa không kiểm tra biên
+ * @T: kiểu pixel của dòng kết quả
+ */
+template <class T>
+void RowConvolver::applyRow(const uchar* const* rows, int cols, int cn, T* out) const {
+    int lo = std::min(r, cols), hi = std::max(lo, cols - (k - 1 - r));
+
+    // các dòng kernel nằm trong ảnh
+    int i0 = 0, i1 = k;
+    while (i0 < k && !rows[i0]) {
+        ++i0;
+    }
+    while (i1 > i0 && !rows[i1 - 1]) {
+        --i1;
+    }
+
+    auto pixel = [&] (int y, int j0, int j1) {
+        for (int c = 0; c < cn; ++c) {
+            double gxy = 0;
+            for (int i = i0; i < i1; ++i) {
+                const uchar* p = rows[i] + (y - r) * cn + c;
+                const double* wi = &w[i * k];
+                for (int j = j0; j < j1; ++j) {
+                    gxy += p[j * cn] * wi[j];
+                }
+            }
+            out[y * cn + c] = cv::saturate_cast<T>(gxy);
+        }
+    };
+
+    for (int y = 0; y < lo; ++y) {
+        pixel(y, std::max(0, r - y), std::min(k, cols + r - y));
+    }
+    for (int y = lo; y < hi; ++y) {
+        pixel(y, 0, k);
+    }
+    for (int y = hi; y < cols; ++y) {
+        pixel(y, std::max(0, r - y), std::min(k, cols + r - y));
+    }
+}
+
+/**
+ * hàm áp dụng toán tử chập
+ * @src: ảnh chính
+ * @kern: ảnh kernel
+ * @dst: ảnh kết quả
+ * @ddepth: kiểu của ảnh kết quả
+ */
+void convolve(const cv::Mat& src, const cv::Mat& kern, cv::Mat& dst, int ddepth) {
+    if (src.type() != CV_8UC1) {
+        throw std::runtime_error("Anh hoac kernel khong hop le cho phep chap");
+    }
+    if (ddepth != CV_64F && ddepth != CV_8U) {
+        throw std::runtime_error("Khong ho tro kieu anh ket qua cua phep chap");
+    }
+    RowConvolver conv(kern);
+
+    // ảnh kết quả trùng hoặc chồng lên vùng nhớ của ảnh chính thì tính trên bản sao của ảnh chính
+    cv::Mat in = overlaps(src, dst) ? src.clone() : src;
+    dst.create(in.size(), CV_MAKETYPE(ddepth, 1));
+
+    cv::parallel_for_(cv::Range(0, in.rows), [&](const cv::Range& range) {
+        std::vector<const uchar*> rows(conv.size());
+        for (int x = range.start; x < range.end; ++x) {
+            for (int i = 0; i < conv.size(); ++i) {
+                int sx = x + i - conv.anchor();
+                rows[i] = sx >= 0 && sx < in.rows ? in.ptr<uchar>(sx) : nullptr;
+            }
+            if (ddepth == CV_8U) {
+                conv.apply(rows.data(), in.cols, 1, dst.ptr<uchar>(x));
+            }
+            else {
+                conv.apply(rows.data(), in.cols, 1, dst.ptr<double>(x));
+            }
+        }
+    });
+}
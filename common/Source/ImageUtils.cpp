@@ -0,0 +1,41 @@
+#include "ImageUtils.hpp"
+
+/**
+ * hàm kiểm tra ảnh có phải ảnh xám hay không
+ * mỗi dòng được duyệt hết không rẽ nhánh (gộp độ chênh lệch các kênh bằng phép or) để trình biên dịch vector hóa được,
+ * chỉ kiểm tra kết quả sau mỗi dòng nên ảnh màu vẫn dừng sớm
+ * @img: ảnh CV_8UC(n) cần kiểm tra
+ * return: true nếu @img là ảnh xám, ngược lại false
+ **/
+bool is_grayscale(const cv::Mat& img) {
+    int cn = img.channels();
+    if (cn < 3) {
+        return true;
+    }
+
+    for (int i = 0; i < img.rows; ++i) {
+        const uchar* p = img.ptr<uchar>(i);
+        int diff = 0;
+
+        // ảnh là ảnh xám nếu R = G = B, ngược lại là ảnh màu
+        for (int j = 0; j < img.cols; ++j, p += cn) {
+            diff |= (p[0] ^ p[1]) | (p[1] ^ p[2]);
+        }
+        if (diff) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * hàm kiểm tra hai ảnh có dùng chung vùng nhớ hay không
+ * so sánh khoảng [datastart, dataend) của hai ma trận nên bắt được cả ROI chồng lên nhau một phần;
+ * khoảng này là của cả ảnh cha nên hai ROI rời nhau của cùng một ảnh cũng được xem là giao nhau, chỉ tốn thêm một bản sao
+ * @a, @b: hai ảnh cần kiểm tra
+ * return: true nếu vùng dữ liệu của @a và @b giao nhau, ngược lại false
+ **/
+bool overlaps(const cv::Mat& a, const cv::Mat& b) {
+    return a.data && b.data && a.datastart < b.dataend && b.datastart < a.dataend;
+}
@@ -0,0 +1,346 @@
+#include "Pipeline.hpp"
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include "ImageUtils.hpp"
+#include "Histogram.h"
+#include "HistogramEqualizer.h"
+#include "opencv2/core/utility.hpp" // cần hàm cv::parallel_for_
+
+Stage Stage::makeLut(const std::string& name, const std::vector<uchar>& lut) {
+    Stage s;
+    s.kind = LUT, s.name = name, s.lut = lut;
+    return s;
+}
+
+Stage Stage::makeRow(const std::string& name, int out_channels, std::function<void(const uchar*, uchar*, int, int)> row) {
+    Stage s;
+    s.kind = ROW, s.name = name, s.out_channels = out_channels, s.row = row;
+    return s;
+}
+
+Stage Stage::makeStencil(const std::string& name, int radius, int in_channels, int out_channels, std::function<void(const uchar* const*, uchar*, int, int)> stencil) {
+    Stage s;
+    s.kind = STENCIL, s.name = name, s.radius = radius, s.in_channels = in_channels, s.out_channels = out_channels, s.stencil = stencil;
+    return s;
+}
+
+Stage Stage::makePrepare(const std::string& name, std::function<Stage(const cv::Mat&)> prepare) {
+    Stage s;
+    s.kind = PREPARE, s.name = name, s.prepare = prepare;
+    return s;
+}
+
+Stage Stage::makeImage(const std::string& name, std::function<void(const cv::Mat&, cv::Mat&)> image) {
+    Stage s;
+    s.kind = IMAGE, s.name = name, s.image = image;
+    return s;
+}
+
+namespace {
+    // bảng tra của hàm @func trên mọi mức sáng, giá trị được làm tròn và chặn vào [0, 255]
+    template <class Func>
+    std::vector<uchar> tabulate(Func func) {
+        std::vector<uchar> lut(256);
+        for (int v = 0; v < 256; ++v) {
+            lut[v] = cv::saturate_cast<uchar>(func((double)v));
+        }
+        return lut;
+    }
+
+    // chuyển một dòng sang ảnh xám đơn kênh, cùng hệ số dấu phẩy tĩnh với cv::cvtColor(CV_BGR2GRAY)
+    void grayRow(const uchar* in, uchar* out, int cols, int cn) {
+        if (cn == 1) {
+            std::memcpy(out, in, cols);
+            return;
+        }
+        for (int j = 0; j < cols; ++j, in += cn) {
+            out[j] = (uchar)((in[0] * 1868 + in[1] * 9617 + in[2] * 4899 + (1 << 13)) >> 14);
+        }
+    }
+
+    // bỏ khoảng trắng 2 đầu chuỗi
+    std::string trim(const std::string& s) {
+        size_t b = s.find_first_not_of(" \t"), e = s.find_last_not_of(" \t");
+        return b == std::string::npos ? "" : s.substr(b, e - b + 1);
+    }
+}
+
+Pipeline::Pipeline() {
+    // chuyển sang ảnh xám đơn kênh
+    add("gray", [](const StageArgs&) {
+        return Stage::makeRow("gray", 1, grayRow);
+    });
+
+    // ảnh âm bản: x -> 255 - x
+    add("invert", [](const StageArgs&) {
+        return Stage::makeLut("invert", tabulate([](double x) { return 255 - x; }));
+    });
+
+    // biến đổi gamma: x -> x ^ g
+    add("gamma", [](const StageArgs& args) {
+        double g = arg(args, "g", 1);
+        return Stage::makeLut("gamma", tabulate([g](double x) { return std::pow(x, g); }));
+    });
+
+    // đổi độ tương phản và độ sáng: x -> a * x + b
+    add("contrast", [](const StageArgs& args) {
+        double a = arg(args, "a", 1), b = arg(args, "b", 0);
+        return Stage::makeLut("contrast", tabulate([a, b](double x) { return a * x + b; }));
+    });
+
+    // cân bằng histogram ảnh xám: histogram tính trên cả ảnh, sau đó chỉ còn là một bảng tra
+    // ảnh màu được chuyển sang ảnh xám cùng công thức với bước gray: histogram tính trên ảnh xám,
+    // bước kết quả chuyển từng dòng sang xám rồi tra bảng, cho ra ảnh đơn kênh
+    add("hqgray", [](const StageArgs&) {
+        return Stage::makePrepare("hqgray", [](const cv::Mat& img) {
+            if (is_grayscale(img)) {
+                return Stage::makeLut("hqgray", HistogramEqualizer(Histogram(256).calculate(img, 0)).getLUT());
+            }
+
+            int cnt[256] = {0};
+            std::vector<uchar> gray(img.cols);
+            for (int i = 0; i < img.rows; ++i) {
+                grayRow(img.ptr<uchar>(i), gray.data(), img.cols, img.channels());
+                for (int j = 0; j < img.cols; ++j) {
+                    ++cnt[gray[j]];
+                }
+            }
+            std::vector<double> hist(cnt, cnt + 256);
+            for (auto& bin : hist) {
+                bin /= std::max(img.rows * img.cols, 1);
+            }
+            auto lut = HistogramEqualizer(hist, 256).getLUT();
+
+            return Stage::makeRow("hqgray", 1, [lut](const uchar* in, uchar* out, int cols, int cn) {
+                grayRow(in, out, cols, cn);
+                for (int j = 0; j < cols; ++j) {
+                    out[j] = lut[out[j]];
+                }
+            });
+        });
+    });
+
+    // cân bằng histogram độc lập từng kênh: mỗi kênh một bảng tra
+    add("hqrgb", [](const StageArgs&) {
+        return Stage::makePrepare("hqrgb", [](const cv::Mat& img) {
+            std::vector<std::vector<uchar>> luts;
+            for (int c = 0; c < img.channels(); ++c) {
+                luts.push_back(HistogramEqualizer(Histogram(256).calculate(img, c)).getLUT());
+            }
+            return Stage::makeRow("hqrgb", 0, [luts](const uchar* in, uchar* out, int cols, int cn) {
+                for (int j = 0; j < cols; ++j, in += cn, out += cn) {
+                    for (int c = 0; c < cn; ++c) {
+                        out[c] = luts[c][in[c]];
+                    }
+                }
+            });
+        });
+    });
+}
+
+Pipeline& Pipeline::add(const std::string& name, Factory factory) {
+    factories[name] = factory;
+    return *this;
+}
+
+std::vector<std::string> Pipeline::names() const {
+    std::vector<std::string> res;
+    for (auto& f : factories) {
+        res.push_back(f.first);
+    }
+    return res;
+}
+
+double Pipeline::arg(const StageArgs& args, const std::string& key, double def) {
+    auto it = args.find(key);
+    return it == args.end() ? def : it->second;
+}
+
+int Pipeline::kern(const StageArgs& args, int def) {
+    double k = arg(args, "k", def);
+    if (k <= 0 || k != std::floor(k) || std::fmod(k, 2) == 0) {
+        std::ostringstream ss;
+        ss << "Kich thuoc kernel phai la so tu nhien le: " << k;
+        throw std::runtime_error(ss.str());
+    }
+    return (int)k;
+}
+
+Pipeline& Pipeline::parse(const std::string& spec) {
+    stages.clear();
+    std::stringstream ss(spec);
+    std::string token;
+    while (std::getline(ss, token, '|')) {
+        token = trim(token);
+        if (token.empty()) {
+            throw std::runtime_error("Chuoi xu ly co buoc rong: " + spec);
+        }
+
+        // tên bước và phần tham số sau dấu ':'
+        size_t colon = token.find(':');
+        std::string name = trim(token.substr(0, colon));
+        auto it = factories.find(name);
+        if (it == factories.end()) {
+            throw std::runtime_error("Khong ho tro buoc " + name);
+        }
+
+        StageArgs args;
+        if (colon != std::string::npos) {
+            std::stringstream as(token.substr(colon + 1));
+            std::string kv;
+            while (std::getline(as, kv, ',')) {
+                size_t eq = kv.find('=');
+                if (eq == std::string::npos) {
+                    throw std::runtime_error("Tham so khong hop le cua buoc " + name + ": " + kv);
+                }
+                std::string key = trim(kv.substr(0, eq)), value = trim(kv.substr(eq + 1));
+                try {
+                    size_t used;
+                    args[key] = std::stod(value, &used);
+                    if (used != value.size()) {
+                        throw std::invalid_argument(value);
+                    }
+                }
+                catch (const std::logic_error&) {
+                    throw std::runtime_error("Tham so " + key + " cua buoc " + name + " khong phai so: " + value);
+                }
+            }
+        }
+
+        stages.push_back(it->second(args));
+    }
+
+    if (stages.empty()) {
+        throw std::runtime_error("Chuoi xu ly rong");
+    }
+    return *this;
+}
+
+cv::Mat Pipeline::run(const cv::Mat& src) {
+    // ảnh hiện tại và bộ đệm sẽ ghi kế tiếp; nếu đầu vào là kết quả lần chạy trước thì ghi vào bộ đệm còn lại
+    cv::Mat cur = src;
+    int next = buffers[0].data == src.data ? 1 : 0;
+
+    size_t s = 0;
+    while (s < stages.size()) {
+        if (stages[s].kind == Stage::IMAGE) {
+            stages[s].image(cur, buffers[next]);
+            cur = buffers[next];
+            next ^= 1;
+            ++s;
+            continue;
+        }
+
+        // gom các bước theo dòng liền nhau; bước PREPARE chỉ được đứng đầu nhóm vì nó cần cả ảnh hiện tại
+        std::vector<Stage> group;
+        group.push_back(stages[s].kind == Stage::PREPARE ? stages[s].prepare(cur) : stages[s]);
+        for (++s; s < stages.size() && stages[s].kind != Stage::PREPARE && stages[s].kind != Stage::IMAGE; ++s) {
+            group.push_back(stages[s]);
+        }
+
+        runStream(cur, group, buffers[next]);
+        cur = buffers[next];
+        next ^= 1;
+    }
+    return cur;
+}
+
+void Pipeline::runStream(const cv::Mat& src, const std::vector<Stage>& group, cv::Mat& dst) {
+    // gộp các bảng tra liền nhau: áp dụng t1 rồi t2 bằng áp dụng bảng t2[t1[v]],
+    // chèn bước chuyển sang ảnh xám trước bước chỉ nhận ảnh đơn kênh; cns[k] là số kênh nguồn của ops[k]
+    std::vector<Stage> ops;
+    std::vector<int> cns(1, src.channels());
+    for (auto& st : group) {
+        if (st.in_channels == 1 && cns.back() != 1) {
+            ops.push_back(Stage::makeRow("gray", 1, grayRow));
+            cns.push_back(1);
+        }
+        if (st.kind == Stage::LUT && !ops.empty() && ops.back().kind == Stage::LUT) {
+            auto& lut = ops.back().lut;
+            for (int v = 0; v < 256; ++v) {
+                lut[v] = st.lut[lut[v]];
+            }
+            continue;
+        }
+        ops.push_back(st);
+        cns.push_back(st.kind != Stage::LUT && st.out_channels ? st.out_channels : cns.back());
+    }
+    int n = (int)ops.size();
+    dst.create(src.size(), CV_MAKETYPE(CV_8U, cns.back()));
+
+    // halo[k]: số dòng bước k phải tính thêm ở mỗi đầu dải, bằng tổng bán kính các bước sau nó
+    std::vector<int> halo(n, 0);
+    for (int k = n - 2; k >= 0; --k) {
+        halo[k] = halo[k + 1] + ops[k + 1].radius;
+    }
+    int band = 4 * halo[0] > BAND_ROWS ? 4 * halo[0] : BAND_ROWS;
+
+    cv::parallel_for_(cv::Range(0, (src.rows + band - 1) / band), [&](const cv::Range& range) {
+        // bộ đệm vòng của bước k chứa 2 * radius + 1 dòng kết quả gần nhất mà bước k + 1 cần,
+        // bước cuối ghi thẳng vào ảnh kết quả
+        std::vector<std::vector<uchar>> ring(n);
+        std::vector<int> ring_rows(n, 1);
+        for (int k = 0; k + 1 < n; ++k) {
+            ring_rows[k] = 2 * ops[k + 1].radius + 1;
+            ring[k].resize((size_t)ring_rows[k] * src.cols * cns[k + 1]);
+        }
+        std::vector<std::vector<const uchar*>> windows(n);
+        for (int k = 0; k < n; ++k) {
+            windows[k].resize(2 * ops[k].radius + 1);
+        }
+        std::vector<int> next(n);
+
+        // dòng @i (nằm trong ảnh) của kết quả bước @k, k = -1 là ảnh nguồn
+        auto row_of = [&](int k, int i) -> uchar* {
+            if (k < 0) {
+                return const_cast<uchar*>(src.ptr<uchar>(i));
+            }
+            if (k == n - 1) {
+                return dst.ptr<uchar>(i);
+            }
+            return &ring[k][(size_t)(i % ring_rows[k]) * src.cols * cns[k + 1]];
+        };
+
+        // tính tiếp bước @k cho tới hết dòng @i, trước mỗi dòng kéo bước k - 1 tới dòng cuối trong bán kính của nó
+        std::function<void(int, int)> pull = [&](int k, int i) {
+            const Stage& op = ops[k];
+            for (; next[k] <= i; ++next[k]) {
+                int x = next[k];
+                if (k > 0) {
+                    pull(k - 1, std::min(x + op.radius, src.rows - 1));
+                }
+
+                uchar* out = row_of(k, x);
+                if (op.kind == Stage::LUT) {
+                    const uchar* in = row_of(k - 1, x);
+                    const uchar* lut = op.lut.data();
+                    for (int j = 0; j < src.cols * cns[k]; ++j) {
+                        out[j] = lut[in[j]];
+                    }
+                }
+                else if (op.kind == Stage::ROW) {
+                    op.row(row_of(k - 1, x), out, src.cols, cns[k]);
+                }
+                else {
+                    auto& window = windows[k];
+                    for (int t = 0; t < (int)window.size(); ++t) {
+                        int sx = x - op.radius + t;
+                        window[t] = sx >= 0 && sx < src.rows ? row_of(k - 1, sx) : nullptr;
+                    }
+                    op.stencil(window.data(), out, src.cols, cns[k]);
+                }
+            }
+        };
+
+        for (int b = range.start; b < range.end; ++b) {
+            int y0 = b * band, y1 = std::min(src.rows, y0 + band);
+            for (int k = 0; k < n; ++k) {
+                next[k] = std::max(0, y0 - halo[k]);
+            }
+            pull(n - 1, y1 - 1);
+        }
+    });
+}
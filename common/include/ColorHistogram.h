@@ -0,0 +1,185 @@
+#pragma once
+#include <vector>
+#include <utility>
+#include <unordered_map>
+#include <algorithm>
+#include <stdexcept>
+#include "opencv2/imgproc/imgproc.hpp" // cần hàm cvtColor
+
+typedef const cv::Mat& Img;
+
+// số bin tối đa (bins^3) còn lưu histogram dạng mảng đầy đủ
+// 16 x 16 x 16 = 4096 bin, mảng đếm 16KB vẫn nằm gọn trong cache L1/L2
+// lớn hơn ngưỡng này thì chuyển sang dạng thưa (chỉ lưu các bin khác 0)
+const int JOINT_DENSE_LIMIT = 16 * 16 * 16;
+
+// số bin tối đa mà dạng thưa còn đếm qua một mảng phẳng tạm rồi mới nén, 32 x 32 x 32 bin là mảng đếm 128KB;
+// lớn hơn thì đếm bằng bảng băm để bộ nhớ chỉ tỉ lệ với số bin khác 0
+const int JOINT_TABLE_LIMIT = 32 * 32 * 32;
+
+// lớp bao bọc histogram màu kết hợp 3 kênh B x G x R
+// khác với việc tính 3 histogram độc lập, mỗi bin ở đây là một bộ (b, g, r) nên giữ được thông tin đồng xuất hiện của màu
+class ColorHistogram {
+    // số bin trên mỗi kênh màu
+    int bins;
+
+    // histogram dạng đầy đủ, chỉ số phẳng của bin (b, g, r) là (b * bins + g) * bins + r
+    std::vector<double> hist;
+
+    // histogram dạng thưa: danh sách (chỉ số phẳng, xác suất) của các bin khác 0, sắp tăng theo chỉ số
+    std::vector<std::pair<int, double>> entries;
+public:
+    /**
+     * hàm khởi tạo từ số bin mỗi kênh màu
+     * @bins: số bin trên mỗi kênh (1 -> 256), tổng số bin là @bins ^ 3
+     */
+    ColorHistogram(int bins = 8) : bins(std::max(1, std::min(bins, 256))) {}
+
+    // phương thức lấy số bin mỗi kênh
+    int getChannelBins() const {
+        return bins;
+    }
+
+    // phương thức lấy tổng số bin
+    int getBins() const {
+        return bins * bins * bins;
+    }
+
+    // histogram có được lưu dạng thưa không
+    bool isSparse() const {
+        return getBins() > JOINT_DENSE_LIMIT;
+    }
+
+    // phương thức lấy vector histogram dạng đầy đủ (rỗng nếu đang lưu dạng thưa)
+    const std::vector<double>& getHist() const {
+        return hist;
+    }
+
+    // phương thức lấy danh sách bin khác 0 (rỗng nếu đang lưu dạng đầy đủ)
+    const std::vector<std::pair<int, double>>& getEntries() const {
+        return entries;
+    }
+
+    /**
+     * phương thức tính histogram kết hợp của một ảnh màu, chỉ duyệt ảnh một lần
+     * @img: ảnh màu CV_8UC3
+     * @return: chính mình
+     */
+    ColorHistogram& calculate(Img img) {
+        if (img.type() != CV_8UC3) {
+            throw std::runtime_error("Histogram mau ket hop can anh CV_8UC3");
+        }
+
+        // bảng tra phần đóng góp của mỗi kênh vào chỉ số phẳng
+        // lượng hóa giống Histogram: bin của mức sáng v là v * bins / 256
+        int lut_b[256], lut_g[256], lut_r[256];
+        for (int v = 0; v < 256; ++v) {
+            int bin = v * bins >> 8;
+            lut_b[v] = bin * bins * bins;
+            lut_g[v] = bin * bins;
+            lut_r[v] = bin;
+        }
+
+        double total = img.rows * img.cols;
+        hist.clear();
+        entries.clear();
+
+        // duyệt ảnh một lần, gọi @count với chỉ số phẳng của mỗi pixel
+        auto scan = [&](auto count) {
+            for (int i = 0; i < img.rows; ++i) {
+                auto row = img.ptr<cv::Vec3b>(i);
+                for (int j = 0; j < img.cols; ++j) {
+                    count(lut_b[row[j][0]] + lut_g[row[j][1]] + lut_r[row[j][2]]);
+                }
+            }
+        };
+
+        if (getBins() <= JOINT_TABLE_LIMIT) {
+            // đếm trực tiếp vào mảng phẳng
+            std::vector<int> cnt(getBins());
+            scan([&](int idx) { ++cnt[idx]; });
+
+            if (!isSparse()) {
+                // dạng đầy đủ: chuẩn hóa về phân bố xác suất
+                hist.assign(cnt.begin(), cnt.end());
+                for (auto& bin : hist) {
+                    bin /= total;
+                }
+            }
+            else {
+                // dạng thưa: nén các bin khác 0, thứ tự chỉ số tăng dần có sẵn
+                for (int idx = 0; idx < getBins(); ++idx) {
+                    if (cnt[idx]) {
+                        entries.emplace_back(idx, cnt[idx] / total);
+                    }
+                }
+            }
+            return *this;
+        }
+
+        // quá nhiều bin cho mảng phẳng: đếm bằng bảng băm rồi chỉ sắp xếp các bin khác 0
+        std::unordered_map<int, int> cnt;
+        scan([&](int idx) { ++cnt[idx]; });
+        entries.reserve(cnt.size());
+        for (auto& bin : cnt) {
+            entries.emplace_back(bin.first, bin.second / total);
+        }
+        std::sort(entries.begin(), entries.end());
+
+        return *this;
+    }
+
+    /**
+     * phương thức duyệt các bin khác 0 theo thứ tự tăng dần của chỉ số phẳng
+     * @func: hàm được gọi với (chỉ số phẳng, xác suất) của mỗi bin
+     */
+    template <class Func>
+    void forEach(Func func) const {
+        for (int i = 0; i < (int)hist.size(); ++i) {
+            if (hist[i] != 0) {
+                func(i, hist[i]);
+            }
+        }
+        for (auto& entry : entries) {
+            func(entry.first, entry.second);
+        }
+    }
+
+    /**
+     * hàm duyệt song song 2 histogram kết hợp trên các bin mà ít nhất một histogram khác 0
+     * các bin mà cả 2 đều bằng 0 bị bỏ qua, nên các phép so sánh dựa trên hàm này chạy trong O(số bin khác 0)
+     * @H1: histogram thứ nhất
+     * @H2: histogram thứ 2, phải có cùng số bin với @H1
+     * @func: hàm được gọi với (h1[i], h2[i]) trên mỗi bin i
+     */
+    template <class Func>
+    static void zip(const ColorHistogram& H1, const ColorHistogram& H2, Func func) {
+        if (H1.getBins() != H2.getBins()) {
+            throw std::runtime_error("Hai histogram khong cung so bin");
+        }
+
+        // dạng đầy đủ: duyệt tuần tự cả 2 mảng
+        if (!H1.isSparse()) {
+            for (int i = 0; i < H1.getBins(); ++i) {
+                func(H1.hist[i], H2.hist[i]);
+            }
+            return;
+        }
+
+        // dạng thưa: trộn 2 danh sách đã sắp theo chỉ số
+        auto& e1 = H1.entries;
+        auto& e2 = H2.entries;
+        size_t i = 0, j = 0;
+        while (i < e1.size() || j < e2.size()) {
+            if (j == e2.size() || (i < e1.size() && e1[i].first < e2[j].first)) {
+                func(e1[i++].second, 0.0);
+            }
+            else if (i == e1.size() || e2[j].first < e1[i].first) {
+                func(0.0, e2[j++].second);
+            }
+            else {
+                func(e1[i++].second, e2[j++].second);
+            }
+        }
+    }
+};
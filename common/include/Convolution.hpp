@@ -0,0 +1,49 @@
+#pragma once
+#include <vector>
+#include "opencv2/core/core.hpp"
+
+/**
+ * hàm áp dụng toán tử chập, kernel đặt tâm tại pixel đang tính, pixel ngoài ảnh xem như bằng 0
+ * kernel cạnh chẵn (ví dụ Roberts 2 x 2) có tâm lệch về phía trên bên trái, tức cửa sổ là [x, x + 1] x [y, y + 1]
+ * @src: ảnh chính, đơn kênh, kiểu uchar
+ * @kern: ảnh kernel vuông, đơn kênh, kiểu double
+ * @dst: ảnh kết quả cùng kích thước với @src, kiểu @ddepth (CV_64F hoặc CV_8U, khi đó giá trị được làm tròn và chặn
+ *       vào [0, 255]); được tạo lại nếu chưa đúng kích thước và kiểu, có thể trùng với @src
+ * @ddepth: kiểu của ảnh kết quả
+ */
+void convolve(const cv::Mat& src, const cv::Mat& kern, cv::Mat& dst, int ddepth = CV_64F);
+
+/**
+ * lớp chập từng dòng một, cùng quy ước và cùng thứ tự cộng với hàm convolve nên kết quả trùng khớp từng bit
+ * dùng khi ảnh không có sẵn cả khung mà được đưa vào theo dòng (chuỗi xử lý dạng luồng)
+ */
+class RowConvolver {
+    int k;
+    int r;
+    std::vector<double> w;
+public:
+    /**
+     * hàm khởi tạo, kernel được lật sẵn một lần
+     * @kern: ảnh kernel vuông, đơn kênh, kiểu double
+     */
+    RowConvolver(const cv::Mat& kern);
+
+    // số dòng ảnh nguồn phía trên dòng đang tính mà kernel phủ lên; phía dưới là size() - 1 - anchor()
+    int anchor() const { return r; }
+
+    // cạnh kernel
+    int size() const { return k; }
+
+    /**
+     * phương thức tính một dòng kết quả, các kênh được chập độc lập
+     * @rows: size() con trỏ tới các dòng x - anchor() ... x + size() - 1 - anchor() của ảnh nguồn, nullptr với dòng ngoài ảnh
+     * @cols: số pixel mỗi dòng
+     * @cn: số kênh
+     * @out: dòng kết quả cols * cn phần tử; kiểu uchar thì giá trị được làm tròn và chặn vào [0, 255]
+     */
+    void apply(const uchar* const* rows, int cols, int cn, uchar* out) const;
+    void apply(const uchar* const* rows, int cols, int cn, double* out) const;
+private:
+    template <class T>
+    void applyRow(const uchar* const* rows, int cols, int cn, T* out) const;
+};
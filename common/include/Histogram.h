@@ -0,0 +1,175 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "opencv2/imgproc/imgproc.hpp" // cần hàm cvtColor
+
+typedef const cv::Mat& Img;
+
+#define SAMPLE_ALL    "all"    // dùng mọi pixel
+#define SAMPLE_STRIDE "stride" // lấy 1 pixel sau mỗi @step pixel theo cả 2 chiều
+#define SAMPLE_RANDOM "random" // lấy ngẫu nhiên @fraction số pixel với hạt giống @seed
+#define SAMPLE_PYR    "pyr"    // đọc ảnh ở tầng @step của kim tự tháp ảnh, việc giảm kích thước làm lúc đọc ảnh
+
+/**
+ * cấu hình lấy mẫu pixel khi tính histogram
+ * histogram chỉ dùng để so sánh/tra cứu nên không cần duyệt hết mọi pixel
+ *
+ * sai số với SAMPLE_RANDOM, gọi n là số pixel lấy được, k là số bin, p là xác suất thật của một bin:
+ *     - độ lệch chuẩn của mỗi bin là sqrt(p * (1 - p) / n) <= 1 / (2 * sqrt(n))
+ *     - theo bất đẳng thức Hoeffding, P(|p' - p| > eps) <= 2 * exp(-2 * n * eps ^ 2) trên mỗi bin
+ *     - kỳ vọng tổng sai số L1 trên cả histogram không quá sqrt(k / n)
+ *     ví dụ n = 100000, k = 16: mỗi bin sai không quá 0.0062 với xác suất 99.9%, sai số L1 trung bình <= 0.013
+ * SAMPLE_STRIDE cho sai số cùng bậc với n = số pixel lấy được, trừ khi ảnh có hoa văn lặp lại đúng chu kỳ @step
+ * SAMPLE_PYR lấy trung bình các pixel lân cận nên histogram bị làm mượt (hẹp lại), không có cận sai số như trên,
+ * đổi lại bộ giải mã (ví dụ JPEG) có thể giải mã thẳng ở độ phân giải thấp, bỏ qua việc giải mã toàn bộ ảnh
+ */
+struct Sampling {
+    std::string mode = SAMPLE_ALL;
+    int step = 1;
+    double fraction = 1;
+    unsigned seed = 0;
+};
+
+/**
+ * hàm lấy mẫu pixel của ảnh theo cấu hình lấy mẫu
+ * @img: ảnh đầu vào, kiểu pixel bất kỳ
+ * @sampling: cấu hình lấy mẫu
+ * @return: ảnh chỉ gồm các pixel được lấy mẫu, histogram của ảnh này xấp xỉ histogram của @img
+ *          với SAMPLE_ALL và SAMPLE_PYR hoặc khi @img rỗng trả về chính @img (không sao chép)
+ */
+inline cv::Mat sample_pixels(Img img, const Sampling& sampling) {
+    // ảnh rỗng không có pixel nào để lấy mẫu
+    if (img.empty()) {
+        return img;
+    }
+
+    // mỗi pixel được chép nguyên @ps byte nên dùng được cho ảnh có số kênh bất kỳ
+    size_t ps = img.elemSize();
+
+    // lấy 1 pixel sau mỗi @step pixel trên cả dòng và cột
+    if (sampling.mode == SAMPLE_STRIDE && sampling.step > 1) {
+        int step = sampling.step;
+        cv::Mat res((img.rows + step - 1) / step, (img.cols + step - 1) / step, img.type());
+        for (int i = 0; i < res.rows; ++i) {
+            const uchar* src = img.ptr<uchar>(i * step);
+            uchar* dst = res.ptr<uchar>(i);
+            for (int j = 0; j < res.cols; ++j, dst += ps) {
+                std::memcpy(dst, src + j * step * ps, ps);
+            }
+        }
+        return res;
+    }
+
+    // lấy ngẫu nhiên @fraction số pixel (có lặp lại), kết quả là ảnh 1 dòng
+    if (sampling.mode == SAMPLE_RANDOM && sampling.fraction < 1) {
+        int n = std::max(1, (int)std::lround(sampling.fraction * img.rows * img.cols));
+        cv::RNG rng(sampling.seed);
+        cv::Mat res(1, n, img.type());
+        uchar* dst = res.ptr<uchar>(0);
+        for (int k = 0; k < n; ++k, dst += ps) {
+            int i = rng.uniform(0, img.rows), j = rng.uniform(0, img.cols);
+            std::memcpy(dst, img.ptr<uchar>(i) + j * ps, ps);
+        }
+        return res;
+    }
+
+    return img;
+}
+
+// lớp bao bọc Histogram
+class Histogram {
+    // vector histogram
+    std::vector<double> hist;
+    int upper_bound = 256;
+
+    // mặt nạ màu (dùng trong việc vẽ histogram lên ảnh)
+    cv::Vec3b mask;
+public:
+    /**
+     * hàm khởi tạo từ số bin màu số mức xám và mặt nạ màu
+     * @bins: số bin
+     * @upper_bound: cận trên/số mức xám
+     * @mask: mặt nạ màu để vẽ (nếu cần)
+     */
+    Histogram(int bins = 256, int upper_bound = 256, const cv::Vec3b& mask = 0) : hist(bins), upper_bound(upper_bound), mask(mask) {}
+
+    // hàm khởi tạo từ số bin màu và mặt nạ màu, số mức xám là 256
+    Histogram(int bins, const cv::Vec3b& mask) : hist(bins), mask(mask) {}
+
+    // phương thức lấy vector histogram
+    std::vector<double> getHist() const {
+        return hist;
+    }
+
+    // phương thức lấy mặt nạ màu
+    cv::Vec3b getColorMask() const {
+        return mask;
+    }
+
+    // phương thức lấy số bin
+    int getBins() const {
+        return hist.size();
+    }
+
+    // phương thức lấy số mức xám
+    int getUpperBound() const {
+        return upper_bound;
+    }
+    
+    /**
+     * phương thức tính histogram của một ảnh
+     * mỗi dòng được duyệt thẳng trên mảng byte với bước bằng số kênh, số pixel được đếm theo từng mức sáng
+     * vào bảng 256 phần tử rồi mới gộp vào các bin, nên vòng lặp trong không có phép chia nào
+     * @img: ảnh CV_8UC(n) mà mình sẽ tính histogram
+     * @channel: kênh màu dùng để tính histogram
+     * @return: chính mình
+     */
+    Histogram& calculate(Img img, int channel) {
+        /**
+         * hàm lượng hóa màu
+         * @i: mức sáng
+         * @return: bin của mức sáng @i, mức sáng >= số mức xám được tính vào bin cuối
+         */
+        auto get_bin = [&] (double i) -> int {
+            return std::min((int)(i * hist.size() / upper_bound), (int)hist.size() - 1);
+        };
+
+        // thống kê số pixel mỗi mức sáng
+        int count[256] = {0};
+        int cn = img.channels();
+        for (int i = 0; i < img.rows; ++i) {
+            const uchar* p = img.ptr<uchar>(i) + channel;
+            for (int j = 0; j < img.cols; ++j, p += cn) {
+                ++count[*p];
+            }
+        }
+
+        // gộp vào các bin
+        for (int v = 0; v < 256; ++v) {
+            if (count[v]) {
+                hist[get_bin(v)] += count[v];
+            }
+        }
+
+        // chuẩn hóa histogram, đưa histogram từ dạng tần số về dạng phân bố xác suất
+        for (auto& bin : hist) {
+            bin /= img.rows * img.cols;
+        }
+
+        return *this;
+    }
+
+    /**
+     * phương thức tính histogram của một ảnh trên một phần pixel của ảnh
+     * @img: ảnh mà mình sẽ tính histogram
+     * @channel: kênh màu dùng để tính histogram
+     * @sampling: cấu hình lấy mẫu pixel
+     * @return: chính mình
+     */
+    Histogram& calculate(Img img, int channel, const Sampling& sampling) {
+        return calculate(sample_pixels(img, sampling), channel);
+    }
+};
@@ -0,0 +1,359 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include "Histogram.h"
+#include "ColorHistogram.h"
+#include "opencv2/imgproc/imgproc.hpp" // cần hàm cvtColor
+
+#define CMP_MD_CORELATION "corelation" // hàm tính khoảng cách corelation
+#define CMP_MD_CHISQ      "chisq"      // hàm tính khoảng cách Chi-square
+#define CMP_MD_INTERSECT  "intersect"  // hàm tính khoảng cách intersect
+#define CMP_MD_BHATTACHARYYA "bhattacharyya" // hàm tính khoảng cách Bhattacharyya
+#define CMP_MD_HELLINGER  "hellinger"  // tên khác của khoảng cách Bhattacharyya (giống OpenCV)
+#define CMP_MD_EMD        "emd"        // hàm tính khoảng cách Earth Mover's Distance
+
+// số ô tối đa trên mỗi kênh của lưới thô dùng cho joint_emd: 8 x 8 x 8 = 512 dòng chữ ký
+const int EMD_GRID = 8;
+
+// lớp hỗ trợ so sánh 2 histogram
+class HistogramComparator {
+public:
+    typedef double (*comparator_type)(const Histogram&, const Histogram&);
+    typedef double (*joint_comparator_type)(const ColorHistogram&, const ColorHistogram&);
+    
+    HistogramComparator(comparator_type cmp, joint_comparator_type joint_cmp = nullptr) : cmp(cmp), joint_cmp(joint_cmp) {}
+
+    /**
+     * hàm khởi tạo dựa vào mã chế độ so sánh
+     * @mode: chế độ so sánh, nên bằng CMP_MD_CORELATION, CMP_MD_CHISQ, CMP_MD_INTERSECT,
+     *        CMP_MD_BHATTACHARYYA (CMP_MD_HELLINGER) hoặc CMP_MD_EMD
+     */
+    HistogramComparator(const std::string& mode) {
+        // nếu mã chế độ so sánh là corelation thì dùng hàm so sánh corelation
+        if (mode == CMP_MD_CORELATION) {
+            cmp = HistogramComparator::corelation;
+            joint_cmp = HistogramComparator::joint_corelation;
+            return;
+        }
+
+        // nếu mã chế độ so sánh là intersect thì dùng hàm so sánh intesect
+        if (mode == CMP_MD_INTERSECT) {
+            cmp = HistogramComparator::intersect;
+            joint_cmp = HistogramComparator::joint_intersect;
+            return;
+        }
+
+        // nếu mã chế độ so sánh là chisq thì dùng hàm so sánh chisq
+        if (mode == CMP_MD_CHISQ) {
+            cmp = HistogramComparator::chisq;
+            joint_cmp = HistogramComparator::joint_chisq;
+            return;
+        }
+
+        // nếu mã chế độ so sánh là bhattacharyya/hellinger thì dùng hàm so sánh bhattacharyya
+        if (mode == CMP_MD_BHATTACHARYYA || mode == CMP_MD_HELLINGER) {
+            cmp = HistogramComparator::bhattacharyya;
+            joint_cmp = HistogramComparator::joint_bhattacharyya;
+            return;
+        }
+
+        // nếu mã chế độ so sánh là emd thì dùng hàm so sánh emd
+        if (mode == CMP_MD_EMD) {
+            cmp = HistogramComparator::emd;
+            joint_cmp = HistogramComparator::joint_emd;
+            return;
+        }
+
+        // mã chế độ không hợp lệ thì báo lỗi
+        throw std::runtime_error("Phuong thuc so sanh khong hop le: " + mode);
+    }
+    
+    /**
+     * hàm so sánh bằng corelation
+     * công thức: https://docs.opencv.org/3.4/d8/dc8/tutorial_histogram_comparison.html
+     * 
+     * @H1: histogram thứ nhất
+     * @H2: histogram thứ 2
+     * @return: độ chênh lệch giữa 2 histogram
+     */
+    static double corelation(const Histogram& H1, const Histogram& H2) {
+        // trích 2 vector histogram
+        auto h1 = H1.getHist(), h2 = H2.getHist();
+
+        // tính số bin
+        int num_bins = H1.getBins();
+
+        // tính trung bình của histogram thứ nhất
+        auto h1_bar = std::accumulate(h1.begin(), h1.end(), 0) / num_bins;
+
+        // tính trung bình của histogram thứ 2
+        auto h2_bar = std::accumulate(h2.begin(), h2.end(), 0) / num_bins;
+
+        double numerator = 0, var1 = 0, var2 = 0;
+        for (int i = 0; i < num_bins; ++i) {
+            numerator += (h1[i] - h1_bar) * (h2[i] - h2_bar);
+            var1 += std::pow(h1[i] - h1_bar, 2);
+            var2 += std::pow(h2[i] - h2_bar, 2);
+        }
+
+        return numerator / std::sqrt(var1 * var2);
+    }
+    
+    /**
+     * hàm so sánh bằng Chi-square
+     * công thức: dist(H1, H2) = sum((H1[i] - H2[i]) ^ 2 / H1[i]) for every intensity i
+     * 
+     * @H1: histogram thứ nhất
+     * @H2: histogram thứ 2
+     * @return: độ chênh lệch giữa 2 histogram
+     */
+    static double chisq(const Histogram& H1, const Histogram& H2) {
+        // trích 2 vector histogram
+        auto h1 = H1.getHist(), h2 = H2.getHist();
+
+        // tính số bin
+        int num_bins = H1.getBins();
+
+        double dist = 0;
+        for (int i = 0; i < num_bins; ++i) {
+            if (h1[i] != 0) {
+                dist += std::pow(h1[i] - h2[i], 2) / h1[i];
+            }
+        }
+
+        return dist;
+    }
+    
+    /**
+     * hàm so sánh bằng intersect
+     * công thức: dist(H1, H2) = min(H1[i], H2[i]) for every intensity i
+     * 
+     * @H1: histogram thứ nhất
+     * @H2: histogram thứ 2
+     * @return: độ chênh lệch giữa 2 histogram
+     */
+    static double intersect(const Histogram& H1, const Histogram& H2) {
+        // trích 2 vector histogram
+        auto h1 = H1.getHist(), h2 = H2.getHist();
+
+        // tính số bin
+        int num_bins = H1.getBins();
+
+        double dist = 0;
+        for (int i = 0; i < num_bins; ++i) {
+            dist += std::min(h1[i], h2[i]);
+        }
+
+        return dist;
+    }
+    
+    /**
+     * hàm so sánh bằng Bhattacharyya (còn gọi là Hellinger)
+     * công thức: dist(H1, H2) = sqrt(1 - sum(sqrt(H1[i] * H2[i])) / sqrt(sum(H1) * sum(H2)))
+     * 
+     * @H1: histogram thứ nhất
+     * @H2: histogram thứ 2
+     * @return: độ chênh lệch giữa 2 histogram, 0 nếu giống nhau, 1 nếu không giao nhau
+     */
+    static double bhattacharyya(const Histogram& H1, const Histogram& H2) {
+        // trích 2 vector histogram
+        auto h1 = H1.getHist(), h2 = H2.getHist();
+
+        // tính số bin
+        int num_bins = H1.getBins();
+
+        double bc = 0, sum1 = 0, sum2 = 0;
+        for (int i = 0; i < num_bins; ++i) {
+            bc += std::sqrt(h1[i] * h2[i]);
+            sum1 += h1[i];
+            sum2 += h2[i];
+        }
+
+        return std::sqrt(std::max(0.0, 1 - bc / std::sqrt(sum1 * sum2)));
+    }
+
+    /**
+     * hàm so sánh bằng Earth Mover's Distance
+     * với histogram 1 chiều và khoảng cách giữa 2 bin kề nhau là 1, bài toán vận chuyển có nghiệm đóng:
+     *     dist(H1, H2) = sum(|C1[i] - C2[i]|) với C1, C2 là hàm phân phối tích lũy của H1, H2
+     * nên chỉ cần O(số bin) thay vì giải bài toán vận chuyển tổng quát
+     * 
+     * @H1: histogram thứ nhất
+     * @H2: histogram thứ 2
+     * @return: độ chênh lệch giữa 2 histogram, tính theo đơn vị bin
+     */
+    static double emd(const Histogram& H1, const Histogram& H2) {
+        // trích 2 vector histogram
+        auto h1 = H1.getHist(), h2 = H2.getHist();
+
+        // tính số bin
+        int num_bins = H1.getBins();
+
+        double cdf1 = 0, cdf2 = 0, dist = 0;
+        for (int i = 0; i < num_bins; ++i) {
+            cdf1 += h1[i];
+            cdf2 += h2[i];
+            dist += std::abs(cdf1 - cdf2);
+        }
+
+        return dist;
+    }
+
+    /**
+     * hàm so sánh 2 histogram kết hợp bằng corelation
+     * các bin bằng 0 ở cả 2 histogram không đóng góp vào các tổng nên chỉ cần duyệt các bin khác 0:
+     *     sum((h1 - m1) * (h2 - m2)) = sum(h1 * h2) - N * m1 * m2
+     *     sum((h1 - m1) ^ 2) = sum(h1 ^ 2) - N * m1 ^ 2
+     * với N là tổng số bin, m1, m2 là trung bình của 2 histogram
+     * 
+     * @H1: histogram thứ nhất
+     * @H2: histogram thứ 2
+     * @return: độ chênh lệch giữa 2 histogram
+     */
+    static double joint_corelation(const ColorHistogram& H1, const ColorHistogram& H2) {
+        double sum1 = 0, sum2 = 0, sum12 = 0, sq1 = 0, sq2 = 0;
+        ColorHistogram::zip(H1, H2, [&] (double h1, double h2) {
+            sum1 += h1;
+            sum2 += h2;
+            sum12 += h1 * h2;
+            sq1 += h1 * h1;
+            sq2 += h2 * h2;
+        });
+
+        double num_bins = H1.getBins();
+        double h1_bar = sum1 / num_bins, h2_bar = sum2 / num_bins;
+        double numerator = sum12 - num_bins * h1_bar * h2_bar;
+        double var1 = sq1 - num_bins * h1_bar * h1_bar;
+        double var2 = sq2 - num_bins * h2_bar * h2_bar;
+
+        return numerator / std::sqrt(var1 * var2);
+    }
+
+    /**
+     * hàm so sánh 2 histogram kết hợp bằng Chi-square, cùng công thức với chisq
+     * @H1: histogram thứ nhất
+     * @H2: histogram thứ 2
+     * @return: độ chênh lệch giữa 2 histogram
+     */
+    static double joint_chisq(const ColorHistogram& H1, const ColorHistogram& H2) {
+        double dist = 0;
+        ColorHistogram::zip(H1, H2, [&] (double h1, double h2) {
+            if (h1 != 0) {
+                dist += (h1 - h2) * (h1 - h2) / h1;
+            }
+        });
+
+        return dist;
+    }
+
+    /**
+     * hàm so sánh 2 histogram kết hợp bằng intersect, cùng công thức với intersect
+     * @H1: histogram thứ nhất
+     * @H2: histogram thứ 2
+     * @return: độ chênh lệch giữa 2 histogram
+     */
+    static double joint_intersect(const ColorHistogram& H1, const ColorHistogram& H2) {
+        double dist = 0;
+        ColorHistogram::zip(H1, H2, [&] (double h1, double h2) {
+            dist += std::min(h1, h2);
+        });
+
+        return dist;
+    }
+    
+    /**
+     * hàm so sánh 2 histogram kết hợp bằng Bhattacharyya, cùng công thức với bhattacharyya
+     * @H1: histogram thứ nhất
+     * @H2: histogram thứ 2
+     * @return: độ chênh lệch giữa 2 histogram
+     */
+    static double joint_bhattacharyya(const ColorHistogram& H1, const ColorHistogram& H2) {
+        double bc = 0, sum1 = 0, sum2 = 0;
+        ColorHistogram::zip(H1, H2, [&] (double h1, double h2) {
+            bc += std::sqrt(h1 * h2);
+            sum1 += h1;
+            sum2 += h2;
+        });
+
+        return std::sqrt(std::max(0.0, 1 - bc / std::sqrt(sum1 * sum2)));
+    }
+
+    /**
+     * hàm so sánh 2 histogram kết hợp bằng Earth Mover's Distance
+     * trong không gian 3 chiều không còn nghiệm đóng như emd nên dùng bộ giải vận chuyển cv::EMD,
+     * khoảng cách giữa 2 bin là khoảng cách L1 trên lưới (b, g, r)
+     * chi phí: bộ giải dựng ma trận chi phí đầy đủ n1 x n2 rồi chạy simplex trên đó, với n1, n2 là số bin khác 0,
+     * nên với --bin=16 (tới 4096 bin) đã mất hàng phút và có thể hết bộ nhớ; vì vậy histogram được gộp về lưới thô
+     * tối đa EMD_GRID bin mỗi kênh (tối đa 512 dòng chữ ký) trước khi giải, mỗi ô thô đặt tại tâm các bin nó gộp
+     * nên kết quả vẫn tính theo đơn vị bin gốc, nhưng chỉ là xấp xỉ khi số bin mỗi kênh lớn hơn EMD_GRID
+     * 
+     * @H1: histogram thứ nhất
+     * @H2: histogram thứ 2
+     * @return: độ chênh lệch giữa 2 histogram, tính theo đơn vị bin
+     */
+    static double joint_emd(const ColorHistogram& H1, const ColorHistogram& H2) {
+        int bins = H1.getChannelBins();
+        if (H2.getChannelBins() != bins) {
+            throw std::runtime_error("Hai histogram khong cung so bin");
+        }
+
+        // số bin gốc gộp vào một ô thô trên mỗi kênh, và số ô thô mỗi kênh
+        int factor = (bins + EMD_GRID - 1) / EMD_GRID;
+        int grid = (bins + factor - 1) / factor;
+
+        // tọa độ tâm của ô thô @c theo đơn vị bin gốc (ô cuối có thể gộp ít bin hơn)
+        auto center = [&] (int c) {
+            return (c * factor + std::min(bins, (c + 1) * factor) - 1) * 0.5f;
+        };
+
+        // chữ ký của histogram: mỗi dòng là (trọng số, b, g, r) của một ô thô khác 0
+        auto signature = [&] (const ColorHistogram& H) {
+            std::vector<double> coarse(grid * grid * grid);
+            H.forEach([&] (int index, double value) {
+                int b = index / (bins * bins), g = index / bins % bins, r = index % bins;
+                coarse[(b / factor * grid + g / factor) * grid + r / factor] += value;
+            });
+
+            std::vector<cv::Vec4f> rows;
+            for (int i = 0; i < (int)coarse.size(); ++i) {
+                if (coarse[i] != 0) {
+                    rows.emplace_back((float)coarse[i], center(i / (grid * grid)), center(i / grid % grid), center(i % grid));
+                }
+            }
+            return cv::Mat(rows, true).reshape(1);
+        };
+
+        return cv::EMD(signature(H1), signature(H2), cv::DIST_L1);
+    }
+    
+    /**
+     * phương thức so sánh 2 histogram
+     * @H1: histogram thứ nhất
+     * @H2: histogram thứ 2
+     * @return: độ chênh lệch giữa 2 histogram theo phương thức so sánh đã chọn
+     */
+    double operator()(const Histogram& H1, const Histogram& H2) const {
+        return cmp(H1, H2);
+    }
+
+    /**
+     * phương thức so sánh 2 histogram kết hợp B x G x R
+     * @H1: histogram thứ nhất
+     * @H2: histogram thứ 2
+     * @return: độ chênh lệch giữa 2 histogram theo phương thức so sánh đã chọn
+     */
+    double operator()(const ColorHistogram& H1, const ColorHistogram& H2) const {
+        if (!joint_cmp) {
+            throw std::runtime_error("Phuong thuc so sanh khong ho tro histogram ket hop");
+        }
+        return joint_cmp(H1, H2);
+    }
+    
+private:
+    // con trỏ hàm tới hàm dùng để so sánh
+    comparator_type cmp;
+
+    // con trỏ hàm tới hàm dùng để so sánh histogram kết hợp
+    joint_comparator_type joint_cmp = nullptr;
+};
@@ -77,4 +77,66 @@ public:
 
         return *this;
     }
+
+    /**
+     * phương thức vẽ nhanh các histogram lên ảnh cho trước, dùng khi cần vẽ hàng loạt (không hiện cửa sổ)
+     * khác với draw: không vẽ điểm tròn ở mỗi bin, nền được tô đen lại nên @canvas có thể dùng lại nhiều lần
+     * (nền đen để histogram xám với mặt nạ GRAY màu trắng vẫn nhìn thấy được),
+     * và đường gấp khúc được vẽ thẳng vào bộ nhớ ảnh thay vì gọi cv::line cho từng đoạn
+     * @canvas: ảnh CV_8UC3 để vẽ, có thể là một vùng con (ROI) của ảnh lớn hơn
+     * @return: chính mình
+     */
+    const HistogramDrawer& render(cv::Mat& canvas) const {
+        canvas.setTo(cv::Scalar::all(0));
+        if (hists.empty() || canvas.empty()) {
+            return *this;
+        }
+
+        // tính xác suất xuất hiện lớn nhất trong tất cả các histogram, giống draw
+        double max_height = 0;
+        for (auto& hist : hists) {
+            for (auto& fr : hist.getHist()) {
+                max_height = std::max(max_height, fr);
+            }
+        }
+        if (max_height == 0) {
+            return *this;
+        }
+
+        int num_bins = hists[0].getBins();
+        double bin_width = (canvas.cols - 1) / std::max(num_bins - 1.0, 1.0);
+
+        // tung độ trên ảnh của mỗi bin, đã giới hạn trong ảnh
+        std::vector<int> ys(num_bins);
+        for (auto& hist : hists) {
+            auto frq = hist.getHist();
+            auto mask = hist.getColorMask();
+            for (int bin = 0; bin < num_bins; ++bin) {
+                ys[bin] = std::min(canvas.rows - 1, (int)((canvas.rows - 1) * (1 - frq[bin] / max_height)));
+            }
+
+            // hoành độ tăng dần theo bin nên đường gấp khúc được vẽ theo từng cột:
+            // tại cột x, tô đoạn dọc nối tung độ của đường tại x và x + 1, như vậy đường luôn liền nét
+            auto y_at = [&] (int x) -> int {
+                double t = x / bin_width;
+                int bin = std::min((int)t, num_bins - 2);
+                if (bin < 0) {
+                    return ys[0];
+                }
+                return ys[bin] + (int)((ys[bin + 1] - ys[bin]) * (t - bin));
+            };
+
+            int last_x = (int)((num_bins - 1) * bin_width);
+            int y0 = y_at(0);
+            for (int x = 0; x <= last_x; ++x) {
+                int y1 = x < last_x ? y_at(x + 1) : y0;
+                for (int y = std::min(y0, y1); y <= std::max(y0, y1); ++y) {
+                    canvas.ptr<cv::Vec3b>(y)[x] = mask;
+                }
+                y0 = y1;
+            }
+        }
+
+        return *this;
+    }
 };
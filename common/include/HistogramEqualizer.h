@@ -0,0 +1,143 @@
+#pragma once
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include "Histogram.h"
+#include "opencv2/imgproc/imgproc.hpp" // cần hàm cvtColor
+
+class HistogramEqualizer {
+    std::vector<double> T;
+public:
+    /**
+     * hàm khởi tạo histogram equalizer từ histogram, nó sẽ tự động cân bằng histogram này mà không cần gọi hàm equalize
+     * @h: histogram cần cân bằng
+     */
+    HistogramEqualizer(const Histogram& h) {
+        equalize(h);
+    }
+
+    /**
+     * hàm khởi tạo từ vector histogram dạng phân bố xác suất (ví dụ IncrementalHistogram::getHist)
+     * @hist: vector histogram
+     * @upper_bound: cận trên/số mức xám
+     */
+    HistogramEqualizer(const std::vector<double>& hist, int upper_bound) {
+        equalize(hist, upper_bound);
+    }
+
+    /**
+     * phương thức cân bằng histogram
+     * @h: histogram cần cân bằng
+     * @return: *this
+     */
+    HistogramEqualizer& equalize(const Histogram& h) {
+        return equalize(h.getHist(), h.getUpperBound());
+    }
+
+    /**
+     * phương thức cân bằng histogram cho dưới dạng vector phân bố xác suất
+     * @hist: vector histogram
+     * @upper_bound: cận trên/số mức xám
+     * @return: *this
+     */
+    HistogramEqualizer& equalize(const std::vector<double>& hist, int upper_bound) {
+        T = hist;
+        for (size_t i = 1; i < T.size(); ++i) {
+            T[i] += T[i - 1];
+        }
+        for (auto& t : T) {
+            t *= (upper_bound - 1);
+        }
+        return *this;
+    }
+
+    /**
+     * phương thức lấy hàm biến đổi dưới dạng bảng tra 8 bit
+     * giá trị T[v] đã được làm tròn và đưa về [0, 255] sẵn, nên khi áp dụng chỉ còn một phép tra bảng mỗi pixel
+     * các mức sáng >= số mức xám của histogram (ví dụ kênh H chỉ có 180 mức) giữ giá trị của mức cuối cùng
+     * @return: bảng tra 256 phần tử
+     */
+    std::vector<uchar> getLUT() const {
+        std::vector<uchar> lut(256);
+        for (int v = 0; v < 256; ++v) {
+            lut[v] = cv::saturate_cast<uchar>(T[std::min(v, (int)T.size() - 1)]);
+        }
+        return lut;
+    }
+
+    /**
+     * phương thức áp dụng hàm biến đổi lên một kênh màu của ảnh
+     * @res: ảnh cần biến đổi, được ghi đè kết quả
+     * @channel: kênh màu
+     * @return: *this
+     */
+    HistogramEqualizer& apply(cv::Mat& res, int channel) {
+        return apply(res, {channel});
+    }
+
+    /**
+     * phương thức áp dụng hàm biến đổi lên nhiều kênh màu của ảnh trong một lần duyệt
+     * ảnh CV_8UC1 chỉ có kênh 0 và được tra thẳng một bảng, ảnh CV_8UC3 đi qua remap
+     * @res: ảnh CV_8UC1 hoặc CV_8UC3 cần biến đổi, được ghi đè kết quả
+     * @channels: danh sách kênh màu cần biến đổi
+     * @return: *this
+     */
+    HistogramEqualizer& apply(cv::Mat& res, std::initializer_list<int> channels) {
+        auto lut = getLUT();
+        for (int c : channels) {
+            if (c < 0 || c >= res.channels()) {
+                throw std::runtime_error("Kenh mau khong hop le: " + std::to_string(c));
+            }
+        }
+
+        if (res.type() == CV_8UC1) {
+            for (int i = 0; i < res.rows; ++i) {
+                uchar* p = res.ptr<uchar>(i);
+                for (int j = 0; j < res.cols; ++j) {
+                    p[j] = lut[p[j]];
+                }
+            }
+            return *this;
+        }
+
+        std::vector<uchar> luts[3];
+        for (int c : channels) {
+            luts[c] = lut;
+        }
+        remap(res, luts);
+        return *this;
+    }
+
+    /**
+     * hàm tra bảng cho cả 3 kênh của ảnh xen kẽ BGR trong một lần duyệt
+     * mỗi kênh có bảng tra riêng, bảng của 3 kênh được gộp thành một bảng 3 x 256 để nằm gọn trong cache L1,
+     * vòng lặp trong duyệt thẳng mảng byte của mỗi dòng, không qua at<cv::Vec3b>
+     * @res: ảnh CV_8UC3 cần biến đổi, được ghi đè kết quả
+     * @luts: bảng tra 256 phần tử của mỗi kênh, bảng rỗng nghĩa là giữ nguyên kênh đó
+     */
+    static void remap(cv::Mat& res, const std::vector<uchar> luts[3]) {
+        if (res.type() != CV_8UC3) {
+            throw std::runtime_error("Tra bang 3 kenh can anh CV_8UC3");
+        }
+
+        uchar tab[3][256];
+        for (int c = 0; c < 3; ++c) {
+            for (int v = 0; v < 256; ++v) {
+                tab[c][v] = luts[c].empty() ? v : luts[c][v];
+            }
+        }
+
+        for (int i = 0; i < res.rows; ++i) {
+            uchar* p = res.ptr<uchar>(i);
+            uchar* end = p + res.cols * 3;
+            for (; p != end; p += 3) {
+                p[0] = tab[0][p[0]];
+                p[1] = tab[1][p[1]];
+                p[2] = tab[2][p[2]];
+            }
+        }
+    }
+};
@@ -0,0 +1,16 @@
+#pragma once
+#include "opencv2/core/core.hpp"
+
+/**
+ * hàm kiểm tra ảnh có phải ảnh xám hay không
+ * @img: ảnh CV_8UC(n) cần kiểm tra
+ * return: true nếu @img là ảnh xám (đơn kênh, hoặc 3 kênh đầu của mọi pixel bằng nhau), ngược lại false
+ **/
+bool is_grayscale(const cv::Mat& img);
+
+/**
+ * hàm kiểm tra hai ảnh có dùng chung vùng nhớ hay không (kể cả khi chỉ là hai ROI chồng lên nhau một phần)
+ * @a, @b: hai ảnh cần kiểm tra
+ * return: true nếu vùng dữ liệu của @a và @b giao nhau, ngược lại false
+ **/
+bool overlaps(const cv::Mat& a, const cv::Mat& b);
@@ -0,0 +1,123 @@
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+#include <functional>
+#include "opencv2/core/core.hpp"
+
+// tham số của một bước, ví dụ bước "gauss:k=5,sd=1" có tham số {k: 5, sd: 1}; kích thước kernel luôn là tham số k
+typedef std::map<std::string, double> StageArgs;
+
+/**
+ * một bước của chuỗi xử lý, có 5 loại:
+ * - LUT: biến đổi từng giá trị pixel bằng bảng tra 256 phần tử, giống nhau trên mọi kênh
+ * - ROW: mỗi dòng kết quả chỉ phụ thuộc vào dòng nguồn cùng chỉ số (ví dụ chuyển sang ảnh xám), có thể đổi số kênh
+ * - STENCIL: mỗi dòng kết quả chỉ phụ thuộc vào các dòng nguồn trong bán kính radius (ví dụ các phép lọc có kernel)
+ * - PREPARE: cần đọc hết ảnh đầu vào trước (ví dụ tính histogram), sau đó trở thành một bước LUT hoặc ROW
+ * - IMAGE: cần cả ảnh đầu vào để tính mỗi pixel
+ */
+struct Stage {
+    enum Kind { LUT, ROW, STENCIL, PREPARE, IMAGE };
+
+    Kind kind;
+    std::string name;
+
+    // LUT: bảng tra
+    std::vector<uchar> lut;
+
+    // ROW: hàm (dòng nguồn, dòng kết quả, số pixel, số kênh nguồn) và số kênh kết quả (0 là giữ nguyên)
+    std::function<void(const uchar*, uchar*, int, int)> row;
+    int out_channels = 0;
+
+    // STENCIL: hàm (các dòng nguồn x - radius ... x + radius, dòng kết quả x, số pixel, số kênh nguồn), dòng ngoài ảnh là nullptr
+    std::function<void(const uchar* const*, uchar*, int, int)> stencil;
+    int radius = 0;
+
+    // số kênh nguồn yêu cầu của bước ROW/STENCIL (0 là nhận mọi số kênh), hiện chỉ hỗ trợ 1:
+    // ảnh nhiều kênh được chuyển sang ảnh xám ngay trong lượt duyệt trước khi vào bước
+    int in_channels = 0;
+
+    // PREPARE: hàm nhận cả ảnh đầu vào, trả về bước LUT hoặc ROW sẽ áp dụng lên chính ảnh đó
+    std::function<Stage(const cv::Mat&)> prepare;
+
+    // IMAGE: hàm (ảnh nguồn, ảnh kết quả), ảnh kết quả không bao giờ trùng ảnh nguồn
+    std::function<void(const cv::Mat&, cv::Mat&)> image;
+
+    static Stage makeLut(const std::string& name, const std::vector<uchar>& lut);
+    static Stage makeRow(const std::string& name, int out_channels, std::function<void(const uchar*, uchar*, int, int)> row);
+    static Stage makeStencil(const std::string& name, int radius, int in_channels, int out_channels, std::function<void(const uchar* const*, uchar*, int, int)> stencil);
+    static Stage makePrepare(const std::string& name, std::function<Stage(const cv::Mat&)> prepare);
+    static Stage makeImage(const std::string& name, std::function<void(const cv::Mat&, cv::Mat&)> image);
+};
+
+/**
+ * lớp thực thi một chuỗi bước xử lý trong cùng tiến trình, ví dụ "gauss:k=5,sd=1 | hqgray | gra-sobel"
+ * các bước LUT/ROW/STENCIL liền nhau được chạy thành một luồng dòng: mỗi bước có một bộ đệm vòng chứa đúng số dòng
+ * mà bước sau nó cần (2 * radius + 1 dòng), dòng kết quả được tính ngay khi đủ dòng nguồn, nên cả chuỗi chỉ cần
+ * bộ nhớ cỡ chiều rộng x tổng chiều cao kernel và nằm gọn trong cache thay vì một ảnh trung gian cho mỗi bước;
+ * các bảng tra liền nhau được gộp thành một bảng
+ * ảnh được chia thành các dải dòng chạy song song, mỗi dải tính lại phần chồng lấn (tổng bán kính các bước) ở 2 đầu
+ * chỉ bước PREPARE và IMAGE cần cả khung ảnh, kết quả của chúng được ghi luân phiên vào 2 bộ đệm dùng lại giữa các lần chạy
+ */
+class Pipeline {
+public:
+    typedef std::function<Stage(const StageArgs&)> Factory;
+private:
+    // số dòng tối thiểu của một dải khi chạy song song
+    static const int BAND_ROWS = 32;
+
+    std::map<std::string, Factory> factories;
+    std::vector<Stage> stages;
+    cv::Mat buffers[2];
+public:
+    /**
+     * hàm khởi tạo, đăng ký sẵn các bước chỉ dùng thư viện chung:
+     * gray, invert, gamma:g=, contrast:a=,b=, hqgray, hqrgb
+     */
+    Pipeline();
+
+    /**
+     * phương thức đăng ký một loại bước
+     * @name: tên bước dùng trong chuỗi xử lý
+     * @factory: hàm tạo bước từ tham số
+     * @return: chính mình
+     */
+    Pipeline& add(const std::string& name, Factory factory);
+
+    /**
+     * phương thức phân tích chuỗi xử lý, các bước cách nhau bởi '|', tham số viết sau ':' dạng khóa=số, cách nhau bởi ','
+     * @spec: chuỗi xử lý
+     * @return: chính mình
+     */
+    Pipeline& parse(const std::string& spec);
+
+    // danh sách tên các bước đã đăng ký
+    std::vector<std::string> names() const;
+
+    /**
+     * phương thức chạy chuỗi xử lý
+     * @src: ảnh đầu vào CV_8UC(n)
+     * @return: ảnh kết quả, dùng chung bộ nhớ với bộ đệm của pipeline nên sẽ bị ghi đè ở lần chạy sau
+     */
+    cv::Mat run(const cv::Mat& src);
+
+    /**
+     * hàm đọc một tham số của bước
+     * @args: tham số của bước
+     * @key: tên tham số
+     * @def: giá trị mặc định khi không có tham số
+     * @return: giá trị tham số
+     */
+    static double arg(const StageArgs& args, const std::string& key, double def);
+
+    /**
+     * hàm đọc kích thước kernel của bước, mọi bước có kernel đều dùng chung tham số k
+     * @args: tham số của bước
+     * @def: giá trị mặc định khi không có tham số k
+     * @return: kích thước kernel, là số tự nhiên lẻ
+     */
+    static int kern(const StageArgs& args, int def);
+private:
+    // chạy một nhóm bước LUT/ROW/STENCIL liền nhau thành một luồng dòng
+    static void runStream(const cv::Mat& src, const std::vector<Stage>& group, cv::Mat& dst);
+};
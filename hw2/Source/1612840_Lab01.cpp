@@ -3,6 +3,8 @@
 #include <iostream>                    // cần std::cerr, std::endl
 #include "algos.h"                     // định nghĩa các hàm chức năng xử lý trên ảnh
 #include <map>
+#include <vector>
+#include <fstream>                     // cần std::ifstream
 #include "opencv2/highgui/highgui.hpp" // cần các hàm cv::imread, cv::imwrite, cv::imshow, cv::waitKey, cv::namedWindow
 #include "opencv2/imgproc/imgproc.hpp" // cần hàm cvtColor
 
@@ -18,6 +20,8 @@
 #define CMD_HISTOGRAM_GRAY          "hiqg"   // mã lệnh tính histogram xám
 #define CMD_COMPARE_HISTOGRAM_COLOR "cphiqc" // mã lệnh so sánh histogram màu
 #define CMD_COMPARE_HISTOGRAM_GRAY  "cphiqg" // mã lệnh so sánh histogram xám
+#define CMD_COMPARE_HISTOGRAM_JOINT "cphij"  // mã lệnh so sánh histogram màu kết hợp B x G x R
+#define CMD_HISTOGRAM_SHEET         "hisheet" // mã lệnh vẽ histogram của nhiều ảnh vào một ảnh ghép
 #define CMD_SHOW_HELP               "help"   // mã lệnh hiện hướng dẫn
 
 typedef const cv::CommandLineParser& Params;
@@ -25,27 +29,66 @@ typedef const cv::CommandLineParser& Params;
 /**
  * hàm đọc ảnh từ param parser
  * @params: param parser
+ * @flags: cờ đọc ảnh của cv::imread
  * @return: ảnh đọc được từ thông tin của @params
  */
-auto read_img(Params params) {
+auto read_img(Params params, int flags = cv::IMREAD_COLOR) {
     // lấy đường dẫn file từ @params
     auto fname = params.get<std::string>("@path");
 
     // đọc ảnh từ đường dẫn đó
-    return cv::imread(fname);
+    return cv::imread(fname, flags);
 }
 
 /**
  * hàm đọc ảnh thứ 2 (cho các thao tác cần 2 ảnh) từ param parser
  * @params: param parser
+ * @flags: cờ đọc ảnh của cv::imread
  * @return: ảnh đọc được từ thông tin của @params
  */
-auto read_img2(Params params) {
+auto read_img2(Params params, int flags = cv::IMREAD_COLOR) {
     // lấy đường dẫn file từ @params
     auto fname = params.get<std::string>("path2");
 
     // đọc ảnh từ đường dẫn đó
-    return cv::imread(fname);
+    return cv::imread(fname, flags);
+}
+
+/**
+ * hàm đọc cấu hình lấy mẫu pixel cho histogram từ param parser
+ * @params: param parser
+ * @return: cấu hình lấy mẫu
+ */
+Sampling read_sampling(Params params) {
+    Sampling sampling;
+    sampling.mode = params.get<std::string>("sample");
+    sampling.step = params.get<int>("sample_step");
+    sampling.fraction = params.get<double>("sample_frac");
+    sampling.seed = params.get<unsigned>("seed");
+    return sampling;
+}
+
+/**
+ * hàm lấy cờ đọc ảnh cho các lệnh histogram
+ * với chế độ lấy mẫu SAMPLE_PYR, ảnh được đọc thẳng ở độ phân giải 1/2, 1/4 hoặc 1/8,
+ * bộ giải mã JPEG sẽ bỏ qua việc giải mã ảnh đầy đủ, các định dạng khác được OpenCV thu nhỏ sau khi đọc
+ * @params: param parser
+ * @return: cờ đọc ảnh cho cv::imread
+ */
+int read_flags(Params params) {
+    if (params.get<std::string>("sample") != SAMPLE_PYR) {
+        return cv::IMREAD_COLOR;
+    }
+
+    // tầng kim tự tháp ảnh, giới hạn trong 1 -> 3 (tỉ lệ 1/2 -> 1/8)
+    switch (std::max(1, std::min(params.get<int>("sample_step"), 3))) {
+        case 1:
+            return cv::IMREAD_REDUCED_COLOR_2;
+        case 2:
+            return cv::IMREAD_REDUCED_COLOR_4;
+        default:
+            return cv::IMREAD_REDUCED_COLOR_8;
+    }
 }
 
 /**
@@ -96,11 +139,11 @@ void change_brightness(Params params) {
     // lấy thông số beta (đơn vị độ sáng thay đổi): f(x) = alpha * x + beta
     auto beta = params.get<double>("beta");
     
-    // tính ảnh đã thay đổi độ sáng
-    auto res = change_contrast_and_brightness(img, 1, beta);
+    // ảnh đầu vào đã được xuất nên có thể thay đổi độ sáng trực tiếp trên nó
+    change_contrast_and_brightness_inplace(img, 1, beta);
 
     // xuất ảnh ra màn hình
-    show_image(res);
+    show_image(img);
 }
 
 /**
@@ -117,11 +160,11 @@ void change_contrast(Params params) {
     // đọc tham số alpha (tỉ lệ thay đổi độ tương phản): f(x) = alpha * x + beta
     auto alpha = params.get<double>("alpha");
     
-    // tính ảnh đã thay đổi độ tương phản
-    auto res = change_contrast_and_brightness(img, alpha, 0);
+    // ảnh đầu vào đã được xuất nên có thể thay đổi độ tương phản trực tiếp trên nó
+    change_contrast_and_brightness_inplace(img, alpha, 0);
 
     // xuất ảnh ra màn hình
-    show_image(res);
+    show_image(img);
 }
 
 /**
@@ -135,11 +178,11 @@ void invert(Params params) {
     // xuất ảnh đầu vào
     show_image(img, "input");
 
-    // tính ảnh âm bản
-    auto res = invert(img);
+    // tính ảnh âm bản trực tiếp trên ảnh đầu vào
+    invert_inplace(img);
 
     // xuất ảnh ra màn hình
-    show_image(res);
+    show_image(img);
 }
 
 /**
@@ -156,11 +199,11 @@ void log_transform(Params params) {
     // lấy tham số c trong biến đổi log: x -> c * log(x + 1)
     auto c = params.get<double>("c");
 
-    // tính ảnh đã biến đổi log
-    auto res = log_transform(img, c);
+    // biến đổi log trực tiếp trên ảnh đầu vào
+    log_transform_inplace(img, c);
 
     // xuất ảnh ra màn hình
-    show_image(res);
+    show_image(img);
 }
 
 /**
@@ -177,11 +220,11 @@ void gamma_transform(Params params) {
     // lấy tham số gamma trong biến đổi gamma: x -> gamma ^ x
     auto gamma = params.get<double>("gamma");
 
-    // tính ảnh đã biến đổi gamma
-    auto res = gamma_transform(img, gamma);
+    // biến đổi gamma trực tiếp trên ảnh đầu vào
+    gamma_transform_inplace(img, gamma);
 
     // xuất ảnh ra màn hình
-    show_image(res);
+    show_image(img);
 }
 
 /**
@@ -190,16 +233,19 @@ void gamma_transform(Params params) {
  */
 void get_histogram(Params params) {
     // đọc ảnh từ @params
-    auto img = read_img(params);
+    auto img = read_img(params, read_flags(params));
 
     // xuất ảnh đầu vào
     show_image(img, "input");
 
     // lấy tham số số bin
     auto num_bins = params.get<int>("bin");
+
+    // lấy cấu hình lấy mẫu pixel
+    auto sampling = read_sampling(params);
     
     // tính histogram
-    auto his = get_histogram(img, num_bins);
+    auto his = get_histogram(sample_pixels(img, sampling), num_bins);
 
     // xuất ảnh ra màn hình
     show_image(his);
@@ -211,19 +257,22 @@ void get_histogram(Params params) {
  */
 void compare_historam(Params params) {
     // đọc ảnh thứ nhất từ @params
-    auto img1 = read_img(params);
+    auto img1 = read_img(params, read_flags(params));
 
     // đọc ảnh thứ 2 từ @params
-    auto img2 = read_img2(params);
+    auto img2 = read_img2(params, read_flags(params));
 
     // lấy tham số số bin
     auto num_bins = params.get<int>("bin");
 
+    // lấy cấu hình lấy mẫu pixel
+    auto sampling = read_sampling(params);
+
     // lấy phương thức so sánh histogram 2 ảnh
     auto cmp_mode = params.get<std::string>("cmp_mode");
 
     // tính khoảng cách giữa histogram 2 ảnh
-    auto res = compare_histogram(img1, img2, num_bins, HistogramComparator(cmp_mode));
+    auto res = compare_histogram(sample_pixels(img1, sampling), sample_pixels(img2, sampling), num_bins, HistogramComparator(cmp_mode));
 
     // xuất ảnh thứ nhất ra màn hình
     show_image(img1, "first image");
@@ -241,7 +290,7 @@ void compare_historam(Params params) {
  */
 void get_color_histogram(Params params) {
     // đọc ảnh từ @params
-    auto img = read_img(params);
+    auto img = read_img(params, read_flags(params));
 
     // xuất ảnh đầu vào
     show_image(img, "input");
@@ -249,8 +298,11 @@ void get_color_histogram(Params params) {
     // lấy tham số số bin
     auto num_bins = params.get<int>("bin");
 
+    // lấy cấu hình lấy mẫu pixel
+    auto sampling = read_sampling(params);
+
     // lấy ảnh histogram
-    auto res = get_color_histogram(img, num_bins);
+    auto res = get_color_histogram(sample_pixels(img, sampling), num_bins);
 
     // xuất ảnh histogram ra màn hình
     show_image(res);
@@ -262,7 +314,7 @@ void get_color_histogram(Params params) {
  */
 void get_gray_histogram(Params params) {
     // đọc ảnh từ @params
-    auto img = read_img(params);
+    auto img = read_img(params, read_flags(params));
 
     // xuất ảnh đầu vào
     show_image(img, "input");
@@ -270,8 +322,11 @@ void get_gray_histogram(Params params) {
     // lấy tham số số bin
     auto num_bins = params.get<int>("bin");
 
+    // lấy cấu hình lấy mẫu pixel
+    auto sampling = read_sampling(params);
+
     // lấy ảnh histogram
-    auto res = get_gray_histogram(img, num_bins);
+    auto res = get_gray_histogram(sample_pixels(img, sampling), num_bins);
 
     // xuất ảnh histogram ra màn hình
     show_image(res);
@@ -283,19 +338,22 @@ void get_gray_histogram(Params params) {
  */
 void compare_color_histogram(Params params) {
     // đọc ảnh thứ nhất từ @params
-    auto img1 = read_img(params);
+    auto img1 = read_img(params, read_flags(params));
 
     // đọc ảnh thứ 2 từ @params
-    auto img2 = read_img2(params);
+    auto img2 = read_img2(params, read_flags(params));
 
     // lấy tham số số bin
     auto num_bins = params.get<int>("bin");
 
+    // lấy cấu hình lấy mẫu pixel
+    auto sampling = read_sampling(params);
+
     // lấy tham số phương thức so sánh histogram
     auto cmp_mode = params.get<std::string>("cmp_mode");
 
     // tính khoảng cách 2 histogram
-    auto res = compare_color_histogram(img1, img2, num_bins, HistogramComparator(cmp_mode));
+    auto res = compare_color_histogram(sample_pixels(img1, sampling), sample_pixels(img2, sampling), num_bins, HistogramComparator(cmp_mode));
 
     // xuất khoảng cách 2 histogram ra màn hình
     std::cout << "Histogram distance using " + cmp_mode + " method: " << res << std::endl;
@@ -313,19 +371,22 @@ void compare_color_histogram(Params params) {
  */
 void compare_gray_histogram(Params params) {
     // đọc ảnh thứ nhất từ @params
-    auto img1 = read_img(params);
+    auto img1 = read_img(params, read_flags(params));
 
     // đọc ảnh thứ 2 từ @params
-    auto img2 = read_img2(params);
+    auto img2 = read_img2(params, read_flags(params));
     
     // lấy tham số số bin
     auto num_bins = params.get<int>("bin");
 
+    // lấy cấu hình lấy mẫu pixel
+    auto sampling = read_sampling(params);
+
     // lấy phương thức so sánh 2 histogram
     auto cmp_mode = params.get<std::string>("cmp_mode");
 
     // chuyển 2 ảnh sang ảnh xám rồi tính khoảng cách 2 histogram
-    auto res = compare_gray_histogram(img1, img2, num_bins, HistogramComparator(cmp_mode));
+    auto res = compare_gray_histogram(sample_pixels(img1, sampling), sample_pixels(img2, sampling), num_bins, HistogramComparator(cmp_mode));
 
     // xuất khoảng cách 2 histogram ra màn hình
     std::cout << "Histogram distance using " + cmp_mode + " method: " << res << std::endl;
@@ -337,6 +398,80 @@ void compare_gray_histogram(Params params) {
     show_image(img2, "second image");
 }
 
+/**
+ * so sánh histogram màu kết hợp B x G x R của 2 ảnh lấy từ param parser
+ * @params: param parser
+ */
+void compare_joint_histogram(Params params) {
+    // đọc ảnh thứ nhất từ @params
+    auto img1 = read_img(params, read_flags(params));
+
+    // đọc ảnh thứ 2 từ @params
+    auto img2 = read_img2(params, read_flags(params));
+
+    // lấy tham số số bin trên mỗi kênh màu
+    auto num_bins = params.get<int>("bin");
+
+    // lấy cấu hình lấy mẫu pixel
+    auto sampling = read_sampling(params);
+
+    // lấy tham số phương thức so sánh histogram
+    auto cmp_mode = params.get<std::string>("cmp_mode");
+
+    // tính khoảng cách 2 histogram kết hợp
+    auto res = compare_joint_histogram(sample_pixels(img1, sampling), sample_pixels(img2, sampling), num_bins, HistogramComparator(cmp_mode));
+
+    // xuất khoảng cách 2 histogram ra màn hình
+    std::cout << "Histogram distance using " + cmp_mode + " method: " << res << std::endl;
+
+    // xuất ảnh thứ nhất ra màn hình
+    show_image(img1, "first image");
+
+    // xuất ảnh thứ 2 ra màn hình
+    show_image(img2, "second image");
+}
+
+/**
+ * vẽ histogram của nhiều ảnh vào một ảnh ghép lấy từ param parser, không hiện cửa sổ nào
+ * @path là file văn bản, mỗi dòng là đường dẫn tới một ảnh
+ * @params: param parser
+ */
+void get_histogram_sheet(Params params) {
+    // đọc danh sách đường dẫn ảnh
+    std::ifstream list(params.get<std::string>("@path"));
+    std::vector<std::string> fnames;
+    for (std::string line; std::getline(list, line); ) {
+        if (!line.empty()) {
+            fnames.push_back(line);
+        }
+    }
+    if (fnames.empty()) {
+        throw std::runtime_error("Danh sach anh rong");
+    }
+
+    // lấy tham số số bin và cấu hình lấy mẫu
+    auto num_bins = params.get<int>("bin");
+    auto sampling = read_sampling(params);
+
+    // ảnh ghép được cấp phát một lần, mỗi histogram vẽ thẳng vào một ô của nó
+    HistogramAtlas atlas(fnames.size(), params.get<int>("sheet_cols"),
+                         cv::Size(params.get<int>("tile_width"), params.get<int>("tile_height")));
+    for (auto& fname : fnames) {
+        auto tile = atlas.next();
+        auto img = cv::imread(fname, read_flags(params));
+        if (!img.empty()) {
+            render_histogram(sample_pixels(img, sampling), num_bins, tile);
+        }
+    }
+
+    // ghi ảnh ghép ra file
+    auto out = params.get<std::string>("out");
+    if (!atlas.write(out)) {
+        throw std::runtime_error("Khong ghi duoc file " + out);
+    }
+    std::cout << "Rendered " << atlas.size() << " histograms to " << out << std::endl;
+}
+
 typedef void (*cmd_func)(const cv::CommandLineParser&);
 
 // bảng ánh xạ từ chuỗi mã lệnh tới hàm xử lý tương ứng dựa vào param parser
@@ -354,6 +489,8 @@ std::map<std::string, cmd_func> commands =
     {CMD_HISTOGRAM_GRAY, get_gray_histogram},               // lệnh tính histogram xám
     {CMD_COMPARE_HISTOGRAM_COLOR, compare_color_histogram}, // lệnh so sánh 2 histogram màu
     {CMD_COMPARE_HISTOGRAM_GRAY, compare_gray_histogram},    // lệnh so sánh 2 histogram xám
+    {CMD_COMPARE_HISTOGRAM_JOINT, compare_joint_histogram}, // lệnh so sánh 2 histogram màu kết hợp
+    {CMD_HISTOGRAM_SHEET, get_histogram_sheet},             // lệnh vẽ histogram nhiều ảnh vào ảnh ghép
     {CMD_SHOW_HELP, show_help}
 };
 
@@ -380,13 +517,23 @@ auto parseParams(int nargs, char* args[]) {
         "{" CMD_HISTOGRAM_GRAY          "|          | get image gray histogram}"
         "{" CMD_COMPARE_HISTOGRAM_COLOR "|          | compare color histogram of 2 images}"
         "{" CMD_COMPARE_HISTOGRAM_GRAY  "|          | compare gray histogram of 2 images}"
+        "{" CMD_COMPARE_HISTOGRAM_JOINT "|          | compare joint BxGxR color histogram of 2 images (bin = bins per channel)}"
+        "{" CMD_HISTOGRAM_SHEET         "|          | render histograms of the images listed in @path into one sprite sheet}"
         "{" CMD_SHOW_HELP               "|          | show help}"
         "{alpha                          |1         | alpha value for contrast changing}"
         "{beta                           |0         | beta value for brightness changing}"
         "{bin                            |16        | number of bin for a histogram computation}"
         "{c                              |1         | c value for log transformation}"
         "{gamma                          |1         | gamma value for gamma transformation}"
-        "{cmp_mode                       |corelation| compare method for histograms of 2 images (value = corelation / intersect / chisq)}"
+        "{sample                         |all       | pixel sampling for histograms (value = all / stride / random / pyr)}"
+        "{sample_step                    |2         | stride for 'stride' sampling, or pyramid level (1 -> 3) for 'pyr' sampling}"
+        "{sample_frac                    |0.1       | fraction of pixels used by 'random' sampling}"
+        "{seed                           |0         | random seed for 'random' sampling}"
+        "{tile_width                     |160       | histogram tile width for sprite sheet}"
+        "{tile_height                    |120       | histogram tile height for sprite sheet}"
+        "{sheet_cols                     |8         | number of tiles per row in sprite sheet}"
+        "{out                            |histograms.png| output file for sprite sheet}"
+        "{cmp_mode                       |corelation| compare method for histograms of 2 images (value = corelation / intersect / chisq / bhattacharyya / hellinger / emd)}"
         ;
 
     // tạo param parser dựa trên tham số đầu vào và bảng định nghĩa các hàm chức năng
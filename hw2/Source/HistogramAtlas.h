@@ -0,0 +1,64 @@
+#pragma once
+#include <string>
+#include <algorithm>
+#include "opencv2/core/core.hpp"
+#include "opencv2/highgui/highgui.hpp" // cần hàm cv::imwrite
+
+// lớp ảnh ghép (sprite sheet) gồm nhiều ô histogram cùng kích thước
+// toàn bộ các ô dùng chung một vùng nhớ được cấp phát một lần, mỗi ô là một ROI nên có thể vẽ thẳng vào mà không sao chép
+class HistogramAtlas {
+    // ảnh ghép
+    cv::Mat sheet;
+
+    // kích thước mỗi ô
+    cv::Size tile_size;
+
+    // số ô trên mỗi dòng của ảnh ghép
+    int cols;
+
+    // số ô đã dùng
+    int count = 0;
+public:
+    /**
+     * hàm khởi tạo ảnh ghép
+     * @tiles: tổng số ô
+     * @cols: số ô trên mỗi dòng
+     * @tile_size: kích thước mỗi ô
+     */
+    HistogramAtlas(int tiles, int cols, cv::Size tile_size)
+        : sheet((tiles + cols - 1) / cols * tile_size.height, std::min(tiles, cols) * tile_size.width, CV_8UC3, cv::Scalar::all(0)),
+          tile_size(tile_size), cols(cols) {}
+
+    /**
+     * phương thức lấy ô thứ @k của ảnh ghép
+     * @k: chỉ số ô
+     * @return: ROI của ô, vẽ lên ROI này là vẽ lên ảnh ghép
+     */
+    cv::Mat tile(int k) {
+        return sheet(cv::Rect(k % cols * tile_size.width, k / cols * tile_size.height, tile_size.width, tile_size.height));
+    }
+
+    // phương thức lấy ô trống kế tiếp
+    cv::Mat next() {
+        return tile(count++);
+    }
+
+    // phương thức lấy số ô đã dùng
+    int size() const {
+        return count;
+    }
+
+    // phương thức lấy ảnh ghép
+    const cv::Mat& getSheet() const {
+        return sheet;
+    }
+
+    /**
+     * phương thức ghi ảnh ghép ra file
+     * @fname: đường dẫn file
+     * @return: true nếu ghi thành công
+     */
+    bool write(const std::string& fname) const {
+        return cv::imwrite(fname, sheet);
+    }
+};
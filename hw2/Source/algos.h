@@ -1,6 +1,9 @@
 #pragma once
+#include "ImageUtils.hpp"
 #include "Histogram.h"
+#include "ColorHistogram.h"
 #include "HistogramDrawer.h"
+#include "HistogramAtlas.h"
 #include "HistogramComparator.h"
 #include "opencv2/core/core.hpp"
 #include "opencv2/highgui/highgui.hpp" // cần các hàm cv::imread, cv::imwrite, cv::imshow, cv::waitKey, cv::namedWindow
@@ -21,50 +24,36 @@ typedef const cv::Mat& Img;
 // https://docs.opencv.org/3.1.0/de/d25/imgproc_color_conversions.html
 const double coeff[] = {0.114, 0.587, 0.299};
 
-/**
- * hàm kiểm tra ảnh có phải ảnh xám hay không
- * @img: ảnh cần kiểm tra
- * return: true nếu @img là ảnh xám, ngược lại false
- **/
-bool is_grayscale(Img img) {
-    // duyệt từng pixel (i, j) trong ảnh
-    for (int i = 0; i < img.rows; ++i) {
-        for (int j = 0; j < img.cols; ++j) {
-            // lấy thông tin 3 kênh màu Red, Blue, Green của ảnh
-            cv::Vec3b pixel = img.at<cv::Vec3b>(i, j);
-            auto R = pixel[2], G = pixel[1], B = pixel[0];
-
-            // ảnh là ảnh xám nếu R = G = B, ngược lại là ảnh màu
-            if (R != G || G != B) {
-                return false;
-            }
-        }
-    }
-
-    return true;
-}
-
-// hàm chuyển ảnh thành ảnh xám
-// @img: ảnh cần chuyển
-// return: ảnh màu xám tương ứng
-cv::Mat convert_to_gray(Img img) {
-    // tạo ảnh kết quả bằng cách copy từ ảnh ban đầu
-    auto result = img.clone();
+// hàm chuyển ảnh thành ảnh xám, ghi kết quả vào ảnh có sẵn
+// @src: ảnh cần chuyển
+// @result: ảnh màu xám tương ứng; nếu đã đúng kích thước và kiểu thì không cấp phát lại, có thể trùng với @src
+void convert_to_gray(Img src, cv::Mat& result) {
+    // pixel kết quả chỉ phụ thuộc pixel cùng vị trí nên trùng hẳn ảnh đầu vào thì làm tại chỗ được,
+    // còn chồng lên nhau bị lệch (2 ROI của cùng một ảnh) thì tính trên bản sao
+    cv::Mat img = overlaps(src, result) && src.data != result.data ? src.clone() : src;
+    result.create(img.size(), img.type());
 
     // duyệt mỗi pixel (i, j) trong ảnh
     for (int i = 0; i < img.rows; ++i) {
         for (int j = 0; j < img.cols; ++j) {
-            auto& pix = result.at<cv::Vec3b>(i, j);
+            auto pix = img.at<cv::Vec3b>(i, j);
 
             // c = 0: blue
             // c = 1: green
             // c = 2: red
             double r = pix[2], g = pix[1], b = pix[0];
             double y = r * coeff[2] + g * coeff[1] + b * coeff[0];
-            pix = cv::Vec3b(y, y, y);
+            result.at<cv::Vec3b>(i, j) = cv::Vec3b(y, y, y);
         }
     }
+}
 
+// hàm chuyển ảnh thành ảnh xám
+// @img: ảnh cần chuyển
+// return: ảnh màu xám tương ứng
+cv::Mat convert_to_gray(Img img) {
+    cv::Mat result;
+    convert_to_gray(img, result);
     return result;
 }
 
@@ -84,15 +73,15 @@ cv::Mat revert_color(Img img) {
 }
 
 /**
- * hàm thay đổi độ tương phản và độ sáng của ảnh
- * @img: ảnh đầu vào
+ * hàm thay đổi độ tương phản và độ sáng của ảnh, ghi kết quả vào ảnh có sẵn
+ * @src: ảnh đầu vào
  * @alpha: tỷ lệ thay đổi độ tương phản
  * @beta: độ tăng độ sáng
- * return: một ảnh mới đã có độ tương phản tăng lên @alpha lần và độ sáng tăng @beta đơn vị so với ảnh đầu vào
+ * @result: ảnh kết quả; nếu đã đúng kích thước và kiểu thì không cấp phát lại, có thể trùng với @src
  **/
-cv::Mat change_contrast_and_brightness(Img img, double alpha, double beta) {
-    // tạo ảnh kết quả bằng cách copy từ ảnh ban đầu
-    auto result = img.clone();
+void change_contrast_and_brightness(Img src, double alpha, double beta, cv::Mat& result) {
+    cv::Mat img = overlaps(src, result) && src.data != result.data ? src.clone() : src;
+    result.create(img.size(), img.type());
 
     // duyệt mỗi pixel (i, j) của ảnh
     for (int i = 0; i < result.rows; ++i) {
@@ -111,40 +100,105 @@ cv::Mat change_contrast_and_brightness(Img img, double alpha, double beta) {
             }
         }
     }
+}
+
+/**
+ * hàm thay đổi độ tương phản và độ sáng của ảnh
+ * @img: ảnh đầu vào
+ * @alpha: tỷ lệ thay đổi độ tương phản
+ * @beta: độ tăng độ sáng
+ * return: một ảnh mới đã có độ tương phản tăng lên @alpha lần và độ sáng tăng @beta đơn vị so với ảnh đầu vào
+ **/
+cv::Mat change_contrast_and_brightness(Img img, double alpha, double beta) {
+    cv::Mat result;
+    change_contrast_and_brightness(img, alpha, beta, result);
     return result;
 }
 
 /**
- * hàm biến đổi ảnh theo từng pixel sử dụng một hàm biến đổi cụ thể
- * @img: ảnh cần biến đổi
+ * hàm thay đổi độ tương phản và độ sáng của ảnh, ghi đè kết quả lên chính ảnh đầu vào
+ * @img: ảnh cần thay đổi
+ * @alpha: tỷ lệ thay đổi độ tương phản
+ * @beta: độ tăng độ sáng
+ **/
+void change_contrast_and_brightness_inplace(cv::Mat& img, double alpha, double beta) {
+    change_contrast_and_brightness(img, alpha, beta, img);
+}
+
+/**
+ * hàm biến đổi ảnh theo từng pixel sử dụng một hàm biến đổi cụ thể, ghi kết quả vào ảnh có sẵn
+ * @src: ảnh cần biến đổi
  * @func: hàm biến đổi trên từng pixel - giá trị mới của pixel có giá trị x là func(x)
- * @return: ảnh đã được biến đổi
+ * @res: ảnh đã được biến đổi; nếu đã đúng kích thước và kiểu thì không cấp phát lại, có thể trùng với @src
  */
 template <class Func>
-cv::Mat map(Img img, Func func) {
-    cv::Mat res = img.clone();
-    
+void map(Img src, Func func, cv::Mat& res) {
+    cv::Mat img = overlaps(src, res) && src.data != res.data ? src.clone() : src;
+    res.create(img.size(), img.type());
+
     // với mỗi pixcel (i, j) và kênh màu c, áp dụng hàm @func lên nó
     for (int i = 0; i < img.rows; ++i) {
         for (int j = 0; j < img.cols; ++j) {
-            auto& pix = res.at<cv::Vec3b>(i, j);
+            auto pix = img.at<cv::Vec3b>(i, j);
+            auto& out = res.at<cv::Vec3b>(i, j);
             for (int c = 0; c < img.channels(); ++c) {
-                pix[c] = cv::saturate_cast<uchar>(func(pix[c]));
+                out[c] = cv::saturate_cast<uchar>(func(pix[c]));
             }
         }
     }
+}
 
+/**
+ * hàm biến đổi ảnh theo từng pixel sử dụng một hàm biến đổi cụ thể
+ * @img: ảnh cần biến đổi
+ * @func: hàm biến đổi trên từng pixel - giá trị mới của pixel có giá trị x là func(x)
+ * @return: ảnh đã được biến đổi
+ */
+template <class Func>
+cv::Mat map(Img img, Func func) {
+    cv::Mat res;
+    map(img, func, res);
     return res;
 }
 
+/**
+ * hàm tạo ảnh âm bản từ 1 ảnh
+ * @img: ảnh cần tạo ảnh âm bản
+ * @res: ảnh âm bản, có thể trùng với @img
+ */
+void invert(Img img, cv::Mat& res) {
+    // áp dụng hàm x -> 255 - x lên từng pixel và kênh màu của ảnh
+    map(img, [] (double x) {return 255 - x;}, res);
+}
+
 /**
  * hàm tạo ảnh âm bản từ 1 ảnh
  * @img: ảnh cần tạo ảnh âm bản
  * @return: ảnh âm bản được tạo ra
  */
 cv::Mat invert(Img img) {
-    // áp dụng hàm x -> 255 - x lên từng pixel và kênh màu của ảnh
-    return map(img, [] (double x) {return 255 - x;});
+    cv::Mat res;
+    invert(img, res);
+    return res;
+}
+
+/**
+ * hàm tạo ảnh âm bản, ghi đè kết quả lên chính ảnh đầu vào
+ * @img: ảnh cần tạo ảnh âm bản
+ */
+void invert_inplace(cv::Mat& img) {
+    invert(img, img);
+}
+
+/**
+ * hàm biến đổi log transform
+ * @img: ảnh cần biến đổi
+ * @c: tham số trong biến đổi log
+ * @res: ảnh đã được biến đổi, có thể trùng với @img
+ */
+void log_transform(Img img, double c, cv::Mat& res) {
+    // áp dụng hàm x -> c * log(x + 1) lên từng pixel và kênh màu của ảnh
+    map(img, [c] (double x) {return c * std::log(x + 1);}, res);
 }
 
 /**
@@ -154,8 +208,29 @@ cv::Mat invert(Img img) {
  * @return: ảnh đã được biến đổi
  */
 cv::Mat log_transform(Img img, double c) {
-    // áp dụng hàm x -> c * log(x + 1) lên từng pixel và kênh màu của ảnh
-    return map(img, [c] (double x) {return c * std::log(x + 1);});
+    cv::Mat res;
+    log_transform(img, c, res);
+    return res;
+}
+
+/**
+ * hàm biến đổi log transform, ghi đè kết quả lên chính ảnh đầu vào
+ * @img: ảnh cần biến đổi
+ * @c: tham số trong biến đổi log
+ */
+void log_transform_inplace(cv::Mat& img, double c) {
+    log_transform(img, c, img);
+}
+
+/**
+ * hàm biến đổi gamma transform
+ * @img: ảnh cần biến đổi
+ * @gamma: tham số trong biến đổi log
+ * @res: ảnh đã được biến đổi, có thể trùng với @img
+ */
+void gamma_transform(Img img, double gamma, cv::Mat& res) {
+    // áp dụng hàm x -> gamma ^ x lên từng pixel và kênh màu của ảnh
+    map(img, [gamma] (double x) {return std::pow(x, gamma);}, res);
 }
 
 /**
@@ -165,8 +240,18 @@ cv::Mat log_transform(Img img, double c) {
  * @return: ảnh đã được biến đổi
  */
 cv::Mat gamma_transform(Img img, double gamma) {
-    // áp dụng hàm x -> gamma ^ x lên từng pixel và kênh màu của ảnh
-    return map(img, [gamma] (double x) {return std::pow(x, gamma);});
+    cv::Mat res;
+    gamma_transform(img, gamma, res);
+    return res;
+}
+
+/**
+ * hàm biến đổi gamma transform, ghi đè kết quả lên chính ảnh đầu vào
+ * @img: ảnh cần biến đổi
+ * @gamma: tham số trong biến đổi log
+ */
+void gamma_transform_inplace(cv::Mat& img, double gamma) {
+    gamma_transform(img, gamma, img);
 }
 
 /**
@@ -232,6 +317,29 @@ cv::Mat get_histogram(Img img, int num_bins) {
     return get_color_histogram(img, num_bins);
 }
 
+/**
+ * hàm vẽ nhanh histogram của ảnh lên ảnh cho trước, không cấp phát ảnh mới
+ * @img: ảnh cần tính histogram
+ * @num_bins: số bin trong histogram
+ * @canvas: ảnh để vẽ, thường là một ô của HistogramAtlas
+ */
+void render_histogram(Img img, int num_bins, cv::Mat& canvas) {
+    // ảnh xám thì vẽ histogram xám
+    if (is_grayscale(img)) {
+        HistogramDrawer()
+            .insert(Histogram(num_bins, GRAY).calculate(img, 0))
+            .render(canvas);
+        return;
+    }
+
+    // ngược lại vẽ histogram mỗi kênh màu
+    HistogramDrawer()
+        .insert(Histogram(num_bins, RED).calculate(img, 2))
+        .insert(Histogram(num_bins, GREEN).calculate(img, 1))
+        .insert(Histogram(num_bins, BLUE).calculate(img, 0))
+        .render(canvas);
+}
+
 /**
  * hàm so sánh 2 histogram xám của 2 ảnh
  * @img1: ảnh thứ nhất
@@ -269,6 +377,20 @@ double compare_color_histogram(Img img1, Img img2, int num_bins, const Histogram
     return std::sqrt(diff_b * diff_b + diff_g * diff_g + diff_r * diff_r);
 }
 
+/**
+ * hàm so sánh histogram màu kết hợp B x G x R của 2 ảnh
+ * khác compare_color_histogram, hàm này giữ được thông tin đồng xuất hiện giữa các kênh màu
+ * @img1: ảnh thứ nhất
+ * @img2: ảnh thứ 2
+ * @num_bins: số bin trên mỗi kênh màu, tổng số bin là @num_bins ^ 3
+ * @cmp: phương thức so sánh histogram
+ * @return: chênh lệch giữa 2 histogram kết hợp
+ */
+double compare_joint_histogram(Img img1, Img img2, int num_bins, const HistogramComparator& cmp) {
+    return cmp(ColorHistogram(num_bins).calculate(img1),
+               ColorHistogram(num_bins).calculate(img2));
+}
+
 /**
  * hàm so sánh histogram của 2 ảnh
  * @img1: ảnh thứ nhất
@@ -0,0 +1,139 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include "opencv2/core/core.hpp"
+#include "opencv2/core/utility.hpp" // cần hàm cv::parallel_for_
+
+typedef const cv::Mat& Img;
+
+// lớp cân bằng histogram thích nghi có giới hạn độ tương phản (CLAHE)
+// ảnh được chia thành lưới các ô, mỗi ô có histogram riêng bị cắt ở ngưỡng clip_limit,
+// phần bị cắt được chia đều lại cho các bin, nên nhiễu ở vùng phẳng không bị khuếch đại quá mức như cân bằng toàn cục
+// mỗi pixel được biến đổi bằng nội suy song tuyến tính giữa bảng tra của 4 ô có tâm gần nó nhất
+// các ô được tính histogram song song, sau đó các dòng được nội suy song song
+class ClaheEqualizer {
+    // số ô theo chiều ngang và chiều dọc
+    cv::Size grid;
+
+    // ngưỡng cắt, tính theo bội số của chiều cao trung bình một bin trong ô
+    double clip_limit;
+public:
+    /**
+     * hàm khởi tạo
+     * @grid: số ô theo chiều ngang và chiều dọc
+     * @clip_limit: ngưỡng cắt, giá trị <= 0 nghĩa là không cắt (cân bằng cục bộ thường)
+     */
+    ClaheEqualizer(cv::Size grid = cv::Size(8, 8), double clip_limit = 40) : grid(grid), clip_limit(clip_limit) {
+        if (grid.width <= 0 || grid.height <= 0) {
+            throw std::runtime_error("So o phai la so nguyen duong");
+        }
+    }
+
+    /**
+     * phương thức áp dụng CLAHE lên ảnh một kênh
+     * @src: ảnh CV_8UC1
+     * @dst: ảnh kết quả, cùng kích thước với @src
+     */
+    void apply(Img src, cv::Mat& dst) const {
+        // số ô không vượt quá kích thước ảnh để ô nào cũng có ít nhất một pixel
+        int gx = std::min(grid.width, src.cols), gy = std::min(grid.height, src.rows);
+
+        // ô (tx, ty) gồm các cột [tx * cols / gx, (tx + 1) * cols / gx) và các dòng tương tự
+        auto col_of = [&](int tx) { return tx * src.cols / gx; };
+        auto row_of = [&](int ty) { return ty * src.rows / gy; };
+
+        // bảng tra của mỗi ô, ô (tx, ty) nằm ở luts[(ty * gx + tx) * 256]
+        std::vector<uchar> luts(gx * gy * 256);
+        cv::parallel_for_(cv::Range(0, gx * gy), [&](const cv::Range& range) {
+            for (int t = range.start; t < range.end; ++t) {
+                int tx = t % gx, ty = t / gx;
+                cv::Rect rect(col_of(tx), row_of(ty), col_of(tx + 1) - col_of(tx), row_of(ty + 1) - row_of(ty));
+                tile_lut(src(rect), &luts[t * 256]);
+            }
+        });
+
+        // vị trí tâm ô và trọng số nội suy theo cột được tính sẵn một lần
+        // pixel nằm ngoài tâm của các ô ở rìa chỉ dùng bảng tra của ô rìa đó
+        std::vector<int> x1(src.cols), x2(src.cols);
+        std::vector<float> xa(src.cols);
+        double tw = (double)src.cols / gx, th = (double)src.rows / gy;
+        for (int j = 0; j < src.cols; ++j) {
+            double txf = j / tw - 0.5;
+            int t = cvFloor(txf);
+            xa[j] = (float)(txf - t);
+            x1[j] = std::max(t, 0) * 256;
+            x2[j] = std::min(t + 1, gx - 1) * 256;
+        }
+
+        dst.create(src.size(), CV_8UC1);
+        cv::parallel_for_(cv::Range(0, src.rows), [&](const cv::Range& range) {
+            for (int i = range.start; i < range.end; ++i) {
+                double tyf = i / th - 0.5;
+                int t = cvFloor(tyf);
+                float ya = (float)(tyf - t);
+                const uchar* lut1 = &luts[std::max(t, 0) * gx * 256];
+                const uchar* lut2 = &luts[std::min(t + 1, gy - 1) * gx * 256];
+
+                const uchar* p = src.ptr<uchar>(i);
+                uchar* q = dst.ptr<uchar>(i);
+                for (int j = 0; j < src.cols; ++j) {
+                    int v = p[j];
+                    float top = lut1[x1[j] + v] * (1 - xa[j]) + lut1[x2[j] + v] * xa[j];
+                    float bottom = lut2[x1[j] + v] * (1 - xa[j]) + lut2[x2[j] + v] * xa[j];
+                    q[j] = cv::saturate_cast<uchar>(top * (1 - ya) + bottom * ya);
+                }
+            }
+        });
+    }
+
+private:
+    /**
+     * phương thức tính bảng tra cân bằng đã cắt histogram của một ô
+     * @tile: vùng ảnh của ô
+     * @lut: 256 phần tử kết quả
+     */
+    void tile_lut(Img tile, uchar* lut) const {
+        int hist[256] = {0};
+        for (int i = 0; i < tile.rows; ++i) {
+            const uchar* p = tile.ptr<uchar>(i);
+            for (int j = 0; j < tile.cols; ++j) {
+                ++hist[p[j]];
+            }
+        }
+
+        int area = tile.rows * tile.cols;
+        if (clip_limit > 0) {
+            // cắt các bin vượt ngưỡng và gom phần dư
+            int limit = std::max(1, (int)(clip_limit * area / 256));
+            int excess = 0;
+            for (int v = 0; v < 256; ++v) {
+                if (hist[v] > limit) {
+                    excess += hist[v] - limit;
+                    hist[v] = limit;
+                }
+            }
+
+            // chia đều phần dư cho mọi bin, phần lẻ còn lại rải cách đều trên dải mức sáng
+            int add = excess / 256, residual = excess % 256;
+            for (int v = 0; v < 256; ++v) {
+                hist[v] += add;
+            }
+            if (residual > 0) {
+                int step = std::max(256 / residual, 1);
+                for (int v = 0; v < 256 && residual > 0; v += step, --residual) {
+                    ++hist[v];
+                }
+            }
+        }
+
+        // bảng tra là hàm phân phối tích lũy chuẩn hóa về [0, 255]
+        double scale = 255.0 / area;
+        int sum = 0;
+        for (int v = 0; v < 256; ++v) {
+            sum += hist[v];
+            lut[v] = cv::saturate_cast<uchar>(sum * scale);
+        }
+    }
+};
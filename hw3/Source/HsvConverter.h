@@ -0,0 +1,184 @@
+#pragma once
+#include <vector>
+#include "ImageUtils.hpp"
+#include "opencv2/core/core.hpp"
+#include "opencv2/core/hal/intrin.hpp" // cần các lệnh SIMD chung của opencv (v_uint8x16, v_load_deinterleave, ...)
+
+typedef const cv::Mat& Img;
+
+// lớp chuyển đổi màu BGR <-> HSV bằng số nguyên
+// cùng quy ước với rgb_to_hsv, hsv_to_rgb: H trong [0, 180), S và V trong [0, 255]
+// các phép chia cho max và (max - min) được thay bằng phép nhân với bảng nghịch đảo dấu phẩy tĩnh,
+// max/min của 3 kênh được tính bằng SIMD sau khi tách 3 kênh xen kẽ của mỗi dòng ra 3 mảng riêng
+// sai số so với các hàm tham chiếu dùng số thực không quá 1 mức trên mỗi kênh
+class HsvConverter {
+    // số bit phần lẻ của các bảng nghịch đảo
+    static const int SHIFT = 16;
+
+    // sdiv[v] ~ 255 * 2^SHIFT / v, dùng tính S = (max - min) * 255 / max
+    unsigned sdiv[256];
+
+    // hdiv[d] ~ 30 * 2^SHIFT / d, dùng tính H = 30 * (hiệu 2 kênh) / (max - min), đơn vị nửa độ
+    unsigned hdiv[256];
+
+    // bộ đệm một dòng: 3 kênh đã tách, max và min của 3 kênh
+    std::vector<uchar> vb, vg, vr, vmax, vmin;
+public:
+    HsvConverter() {
+        sdiv[0] = hdiv[0] = 0;
+        for (int v = 1; v < 256; ++v) {
+            // làm tròn lên để phép dịch bit sau khi nhân cho đúng phần nguyên của phép chia
+            sdiv[v] = ((255u << SHIFT) + v - 1) / v;
+            hdiv[v] = ((30u << SHIFT) + v - 1) / v;
+        }
+    }
+
+    /**
+     * phương thức chuyển một dòng pixel từ BGR sang HSV
+     * @src: dòng BGR xen kẽ, 3 * @n byte
+     * @dst: dòng HSV xen kẽ, 3 * @n byte, có thể trùng @src
+     * @n: số pixel
+     */
+    void bgrToHsvRow(const uchar* src, uchar* dst, int n) {
+        vb.resize(n), vg.resize(n), vr.resize(n), vmax.resize(n), vmin.resize(n);
+
+        // bước 1: tách 3 kênh và tính max/min, 16 pixel mỗi lần nếu có SIMD
+        int j = 0;
+#if CV_SIMD128
+        for (; j + 16 <= n; j += 16) {
+            cv::v_uint8x16 b, g, r;
+            cv::v_load_deinterleave(src + j * 3, b, g, r);
+            cv::v_store(&vb[j], b);
+            cv::v_store(&vg[j], g);
+            cv::v_store(&vr[j], r);
+            cv::v_store(&vmax[j], cv::v_max(cv::v_max(b, g), r));
+            cv::v_store(&vmin[j], cv::v_min(cv::v_min(b, g), r));
+        }
+#endif
+        for (; j < n; ++j) {
+            vb[j] = src[j * 3], vg[j] = src[j * 3 + 1], vr[j] = src[j * 3 + 2];
+            vmax[j] = std::max(vb[j], std::max(vg[j], vr[j]));
+            vmin[j] = std::min(vb[j], std::min(vg[j], vr[j]));
+        }
+
+        // bước 2: tính H, S bằng bảng nghịch đảo
+        for (j = 0; j < n; ++j) {
+            int v = vmax[j], diff = v - vmin[j];
+            int b = vb[j], g = vg[j], r = vr[j];
+            int h = 0;
+            if (diff != 0) {
+                // cùng thứ tự ưu tiên với rgb_to_hsv: max là R, rồi G, rồi B
+                int num, base;
+                if (v == r) {
+                    num = g - b, base = 0;
+                }
+                else if (v == g) {
+                    num = b - r, base = 60;
+                }
+                else {
+                    num = r - g, base = 120;
+                }
+                h = (base << SHIFT) + num * (int)hdiv[diff];
+                if (h < 0) {
+                    h += 180 << SHIFT;
+                }
+                h >>= SHIFT;
+            }
+            dst[j * 3] = h;
+            dst[j * 3 + 1] = (diff * sdiv[v]) >> SHIFT;
+            dst[j * 3 + 2] = v;
+        }
+    }
+
+    /**
+     * phương thức chuyển một dòng pixel từ HSV sang BGR
+     * @src: dòng HSV xen kẽ, 3 * @n byte
+     * @dst: dòng BGR xen kẽ, 3 * @n byte, có thể trùng @src
+     * @n: số pixel
+     */
+    void hsvToBgrRow(const uchar* src, uchar* dst, int n) {
+        for (int j = 0; j < n; ++j) {
+            int h = src[j * 3], s = src[j * 3 + 1], v = src[j * 3 + 2];
+
+            // h đơn vị nửa độ nên mỗi cung 60 độ ứng với 30 mức, f là vị trí trong cung
+            int sector = h / 30, f = h % 30;
+            int p = v * (255 - s) / 255;
+            int q = v * (7650 - s * f) / 7650;
+            int t = v * (7650 - s * (30 - f)) / 7650;
+
+            int r, g, b;
+            switch (sector) {
+                case 0:
+                    r = v, g = t, b = p;
+                    break;
+                case 1:
+                    r = q, g = v, b = p;
+                    break;
+                case 2:
+                    r = p, g = v, b = t;
+                    break;
+                case 3:
+                    r = p, g = q, b = v;
+                    break;
+                case 4:
+                    r = t, g = p, b = v;
+                    break;
+                default:
+                    r = v, g = p, b = q;
+                    break;
+            }
+            dst[j * 3] = b;
+            dst[j * 3 + 1] = g;
+            dst[j * 3 + 2] = r;
+        }
+    }
+
+    /**
+     * phương thức chuyển ảnh từ BGR sang HSV vào ảnh cho trước
+     * @img: ảnh BGR CV_8UC3
+     * @dst: ảnh HSV, được tạo lại nếu chưa đúng kích thước; có thể trùng @img
+     */
+    void bgrToHsv(Img img, cv::Mat& dst) {
+        // các hàm dòng cho phép dòng đích trùng dòng nguồn, chỉ khi hai ảnh lệch nhau mới cần bản sao
+        cv::Mat in = overlaps(img, dst) && img.data != dst.data ? img.clone() : img;
+        dst.create(in.size(), CV_8UC3);
+        for (int i = 0; i < in.rows; ++i) {
+            bgrToHsvRow(in.ptr<uchar>(i), dst.ptr<uchar>(i), in.cols);
+        }
+    }
+
+    /**
+     * phương thức chuyển ảnh từ BGR sang HSV
+     * @img: ảnh BGR CV_8UC3
+     * @return: ảnh HSV
+     */
+    cv::Mat bgrToHsv(Img img) {
+        cv::Mat res;
+        bgrToHsv(img, res);
+        return res;
+    }
+
+    /**
+     * phương thức chuyển ảnh từ HSV sang BGR vào ảnh cho trước
+     * @img: ảnh HSV CV_8UC3
+     * @dst: ảnh BGR, được tạo lại nếu chưa đúng kích thước; có thể trùng @img
+     */
+    void hsvToBgr(Img img, cv::Mat& dst) {
+        cv::Mat in = overlaps(img, dst) && img.data != dst.data ? img.clone() : img;
+        dst.create(in.size(), CV_8UC3);
+        for (int i = 0; i < in.rows; ++i) {
+            hsvToBgrRow(in.ptr<uchar>(i), dst.ptr<uchar>(i), in.cols);
+        }
+    }
+
+    /**
+     * phương thức chuyển ảnh từ HSV sang BGR
+     * @img: ảnh HSV CV_8UC3
+     * @return: ảnh BGR
+     */
+    cv::Mat hsvToBgr(Img img) {
+        cv::Mat res;
+        hsvToBgr(img, res);
+        return res;
+    }
+};
@@ -0,0 +1,192 @@
+#pragma once
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include "Histogram.h"
+#include "opencv2/imgproc/imgproc.hpp" // cần hàm cvtColor
+
+// lớp histogram cập nhật tăng dần
+// thay vì đếm lại từ đầu như Histogram::calculate, histogram được duy trì bằng cách thêm/bớt từng dòng, từng cột
+// hoặc chỉ những pixel thay đổi giữa 2 khung hình, nên chi phí chỉ tỉ lệ với số pixel thay đổi
+class IncrementalHistogram {
+    // số pixel trong mỗi bin
+    std::vector<int> cnt;
+
+    // bảng tra bin của mỗi mức sáng
+    std::vector<int> bin_of;
+
+    // tổng số pixel đang có trong histogram
+    int total = 0;
+
+    // cận trên/số mức xám
+    int upper_bound = 256;
+
+    // kênh màu dùng để tính histogram
+    int channel = 0;
+public:
+    /**
+     * hàm khởi tạo histogram rỗng
+     * @bins: số bin
+     * @upper_bound: cận trên/số mức xám
+     * @channel: kênh màu dùng để tính histogram
+     */
+    IncrementalHistogram(int bins = 256, int upper_bound = 256, int channel = 0)
+        : cnt(bins), bin_of(upper_bound), upper_bound(upper_bound), channel(channel) {
+        // lượng hóa màu giống Histogram::calculate
+        for (int i = 0; i < upper_bound; ++i) {
+            bin_of[i] = i * bins / upper_bound;
+        }
+    }
+
+    // phương thức lấy số bin
+    int getBins() const {
+        return cnt.size();
+    }
+
+    // phương thức lấy số mức xám
+    int getUpperBound() const {
+        return upper_bound;
+    }
+
+    // phương thức lấy tổng số pixel đang có trong histogram
+    int getTotal() const {
+        return total;
+    }
+
+    // phương thức lấy số pixel trong mỗi bin
+    const std::vector<int>& getCounts() const {
+        return cnt;
+    }
+
+    // phương thức lấy vector histogram dạng phân bố xác suất như Histogram::getHist
+    std::vector<double> getHist() const {
+        std::vector<double> hist(cnt.begin(), cnt.end());
+        for (auto& bin : hist) {
+            bin /= std::max(total, 1);
+        }
+        return hist;
+    }
+
+    /**
+     * phương thức tính số pixel có bin không lớn hơn bin của mức sáng @v (hàm phân phối tích lũy chưa chuẩn hóa)
+     * @v: mức sáng
+     * @return: số pixel
+     */
+    int rank(int v) const {
+        int res = 0;
+        for (int b = 0; b <= bin_of[v]; ++b) {
+            res += cnt[b];
+        }
+        return res;
+    }
+
+    // xóa histogram về rỗng
+    IncrementalHistogram& clear() {
+        std::fill(cnt.begin(), cnt.end(), 0);
+        total = 0;
+        return *this;
+    }
+
+    // thêm một pixel có mức sáng @v
+    IncrementalHistogram& add(int v) {
+        ++cnt[bin_of[v]];
+        ++total;
+        return *this;
+    }
+
+    // bớt một pixel có mức sáng @v
+    IncrementalHistogram& remove(int v) {
+        --cnt[bin_of[v]];
+        --total;
+        return *this;
+    }
+
+    /**
+     * phương thức thêm/bớt một đoạn trên dòng @row, từ cột @col_begin tới trước cột @col_end
+     * @img: ảnh đầu vào
+     * @row: chỉ số dòng
+     * @col_begin, @col_end: đoạn cột [col_begin, col_end)
+     * @sign: 1 nếu thêm, -1 nếu bớt
+     * @return: chính mình
+     */
+    IncrementalHistogram& updateRow(Img img, int row, int col_begin, int col_end, int sign) {
+        auto p = img.ptr<cv::Vec3b>(row);
+        for (int j = col_begin; j < col_end; ++j) {
+            cnt[bin_of[p[j][channel]]] += sign;
+        }
+        total += sign * (col_end - col_begin);
+        return *this;
+    }
+
+    /**
+     * phương thức thêm/bớt một đoạn trên cột @col, từ dòng @row_begin tới trước dòng @row_end
+     * @img: ảnh đầu vào
+     * @col: chỉ số cột
+     * @row_begin, @row_end: đoạn dòng [row_begin, row_end)
+     * @sign: 1 nếu thêm, -1 nếu bớt
+     * @return: chính mình
+     */
+    IncrementalHistogram& updateCol(Img img, int col, int row_begin, int row_end, int sign) {
+        for (int i = row_begin; i < row_end; ++i) {
+            cnt[bin_of[img.ptr<cv::Vec3b>(i)[col][channel]]] += sign;
+        }
+        total += sign * (row_end - row_begin);
+        return *this;
+    }
+
+    IncrementalHistogram& addRow(Img img, int row, int col_begin, int col_end) {
+        return updateRow(img, row, col_begin, col_end, 1);
+    }
+
+    IncrementalHistogram& removeRow(Img img, int row, int col_begin, int col_end) {
+        return updateRow(img, row, col_begin, col_end, -1);
+    }
+
+    IncrementalHistogram& addCol(Img img, int col, int row_begin, int row_end) {
+        return updateCol(img, col, row_begin, row_end, 1);
+    }
+
+    IncrementalHistogram& removeCol(Img img, int col, int row_begin, int row_end) {
+        return updateCol(img, col, row_begin, row_end, -1);
+    }
+
+    /**
+     * phương thức thêm cả một vùng hình chữ nhật của ảnh
+     * @img: ảnh đầu vào
+     * @rect: vùng cần thêm
+     * @return: chính mình
+     */
+    IncrementalHistogram& addRect(Img img, const cv::Rect& rect) {
+        for (int i = rect.y; i < rect.y + rect.height; ++i) {
+            addRow(img, i, rect.x, rect.x + rect.width);
+        }
+        return *this;
+    }
+
+    /**
+     * phương thức cập nhật histogram của khung hình @prev thành histogram của khung hình @next
+     * các dòng giống hệt nhau được bỏ qua bằng memcmp, với các dòng còn lại chỉ những pixel thay đổi mới được cập nhật
+     * @prev: khung hình cũ, histogram hiện tại phải chứa toàn bộ khung hình này
+     * @next: khung hình mới, cùng kích thước với @prev
+     * @return: số pixel đã thay đổi
+     */
+    int update(Img prev, Img next) {
+        int changed = 0;
+        for (int i = 0; i < prev.rows; ++i) {
+            auto p = prev.ptr<cv::Vec3b>(i);
+            auto q = next.ptr<cv::Vec3b>(i);
+            if (std::memcmp(p, q, prev.cols * sizeof(cv::Vec3b)) == 0) {
+                continue;
+            }
+            for (int j = 0; j < prev.cols; ++j) {
+                int a = p[j][channel], b = q[j][channel];
+                if (a != b) {
+                    --cnt[bin_of[a]];
+                    ++cnt[bin_of[b]];
+                    ++changed;
+                }
+            }
+        }
+        return changed;
+    }
+};
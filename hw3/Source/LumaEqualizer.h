@@ -0,0 +1,176 @@
+#pragma once
+#include <cmath>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+#include "ImageUtils.hpp"
+#include "HistogramEqualizer.h"
+#include "opencv2/core/core.hpp"
+
+#define LUMA_V "v" // kênh V của HSV: max(b, g, r)
+#define LUMA_Y "y" // kênh Y của YCrCb: 0.299r + 0.587g + 0.114b
+#define LUMA_L "l" // kênh L của Lab, tính trên độ sáng tuyến tính
+
+typedef const cv::Mat& Img;
+
+// lớp cân bằng histogram chỉ trên kênh độ sáng, giữ nguyên màu sắc
+// độ sáng được tính thẳng từ bgr bằng trọng số nguyên, không chuyển cả ảnh sang hệ màu khác rồi chuyển ngược:
+// - v: nhân cả 3 kênh với hệ số V' / V, đúng bằng việc đổi V mà giữ nguyên H, S
+// - y: cộng vào cả 3 kênh độ lệch Y' - Y, đúng bằng việc đổi Y mà giữ nguyên Cr, Cb
+// - l: nhân 3 kênh tuyến tính (đã bỏ gamma sRGB) với tỉ số độ sáng tuyến tính mới/cũ, giữ nguyên sắc độ;
+//      đây là xấp xỉ của việc đổi L mà giữ nguyên a, b của Lab
+class LumaEqualizer {
+    // số mức của độ sáng tuyến tính dùng cho kênh l
+    static const int LIN_LEVELS = 4096;
+
+    // kênh độ sáng, so sánh số nguyên thay vì chuỗi vì luma được gọi trên từng pixel
+    enum { V, Y, L } kind;
+
+    // bảng cho kênh l: sRGB -> tuyến tính, tuyến tính -> sRGB, tuyến tính -> L, L -> tuyến tính
+    std::vector<int> lin, delin, l_of, lin_of;
+public:
+    /**
+     * hàm khởi tạo
+     * @mode: kênh độ sáng dùng để cân bằng
+     */
+    LumaEqualizer(const std::string& mode = LUMA_Y) {
+        if (mode == LUMA_V) {
+            kind = V;
+            return;
+        }
+        if (mode == LUMA_Y) {
+            kind = Y;
+            return;
+        }
+        if (mode != LUMA_L) {
+            throw std::runtime_error("Khong ho tro kenh do sang " + mode);
+        }
+        kind = L;
+
+        // hàm truyền sRGB và công thức L của CIE, L được lưu ở thang [0, 255] giống opencv
+        lin.resize(256), lin_of.resize(256);
+        delin.resize(LIN_LEVELS), l_of.resize(LIN_LEVELS);
+        for (int c = 0; c < 256; ++c) {
+            double x = c / 255.0;
+            x = x <= 0.04045 ? x / 12.92 : std::pow((x + 0.055) / 1.055, 2.4);
+            lin[c] = cvRound(x * (LIN_LEVELS - 1));
+
+            double f = (c * 100.0 / 255 + 16) / 116;
+            double y = f > 6.0 / 29 ? f * f * f : 3 * (6.0 / 29) * (6.0 / 29) * (f - 4.0 / 29);
+            lin_of[c] = cvRound(y * (LIN_LEVELS - 1));
+        }
+        for (int y = 0; y < LIN_LEVELS; ++y) {
+            double t = y / (double)(LIN_LEVELS - 1);
+            double x = t <= 0.0031308 ? t * 12.92 : 1.055 * std::pow(t, 1 / 2.4) - 0.055;
+            delin[y] = cv::saturate_cast<uchar>(x * 255);
+
+            double l = t > 0.008856 ? 116 * std::cbrt(t) - 16 : 903.3 * t;
+            l_of[y] = cv::saturate_cast<uchar>(l * 255 / 100);
+        }
+    }
+
+    /**
+     * phương thức cân bằng ảnh màu
+     * lượt 1 đếm histogram độ sáng, lượt 2 tính lại độ sáng của từng pixel và biến đổi 3 kênh theo bảng tra
+     * @src: ảnh CV_8UC3
+     * @dst: ảnh kết quả, được tạo lại nếu chưa đúng kích thước; có thể trùng @src
+     */
+    void apply(Img src, cv::Mat& dst) const {
+        // pixel đích chỉ phụ thuộc pixel nguồn cùng vị trí nên làm tại chỗ được, chỉ khi hai ảnh lệch nhau mới cần bản sao
+        cv::Mat img = overlaps(src, dst) && src.data != dst.data ? src.clone() : src;
+
+        int cnt[256] = {0};
+        for (int i = 0; i < img.rows; ++i) {
+            const uchar* p = img.ptr<uchar>(i);
+            for (int j = 0; j < img.cols; ++j, p += 3) {
+                ++cnt[luma(p)];
+            }
+        }
+
+        std::vector<double> hist(cnt, cnt + 256);
+        for (auto& bin : hist) {
+            bin /= std::max(img.rows * img.cols, 1);
+        }
+        auto lut = HistogramEqualizer(hist, 256).getLUT();
+
+        dst.create(img.size(), CV_8UC3);
+        if (kind == V) {
+            // hệ số nhân dấu phẩy tĩnh 16 bit cho mỗi V, chỉ 256 giá trị nên tính sẵn
+            int gain[256];
+            for (int v = 1; v < 256; ++v) {
+                gain[v] = (lut[v] << 16) / v;
+            }
+            transform(img, dst, [&](const uchar* p, uchar* q) {
+                int v = luma(p);
+                for (int c = 0; c < 3; ++c) {
+                    q[c] = v == 0 ? lut[0] : (p[c] * gain[v] + (1 << 15)) >> 16;
+                }
+            });
+        }
+        else if (kind == Y) {
+            transform(img, dst, [&](const uchar* p, uchar* q) {
+                int y = luma(p), d = lut[y] - y;
+                for (int c = 0; c < 3; ++c) {
+                    q[c] = cv::saturate_cast<uchar>(p[c] + d);
+                }
+            });
+        }
+        else {
+            transform(img, dst, [&](const uchar* p, uchar* q) {
+                int y = lin_luma(p), target = lin_of[lut[l_of[y]]];
+                if (y == 0) {
+                    q[0] = q[1] = q[2] = delin[target];
+                    return;
+                }
+                float gain = (float)target / y;
+                for (int c = 0; c < 3; ++c) {
+                    q[c] = delin[std::min(cvRound(lin[p[c]] * gain), LIN_LEVELS - 1)];
+                }
+            });
+        }
+    }
+
+    /**
+     * phương thức cân bằng ảnh màu
+     * @img: ảnh CV_8UC3
+     * @return: ảnh đã được cân bằng
+     */
+    cv::Mat apply(Img img) const {
+        cv::Mat res;
+        apply(img, res);
+        return res;
+    }
+
+private:
+    // độ sáng tuyến tính của pixel bgr @p, trọng số Rec.709 nhân 4096
+    int lin_luma(const uchar* p) const {
+        return (lin[p[0]] * 296 + lin[p[1]] * 2929 + lin[p[2]] * 871 + 2048) >> 12;
+    }
+
+    // độ sáng [0, 255] của pixel bgr @p theo kênh đã chọn
+    int luma(const uchar* p) const {
+        if (kind == V) {
+            return std::max(p[0], std::max(p[1], p[2]));
+        }
+        if (kind == Y) {
+            // trọng số 0.114, 0.587, 0.299 nhân 2^14 như opencv
+            return (p[0] * 1868 + p[1] * 9617 + p[2] * 4899 + (1 << 13)) >> 14;
+        }
+        return l_of[lin_luma(p)];
+    }
+
+    /**
+     * hàm duyệt đồng thời 2 ảnh bgr cùng kích thước, gọi @func với con trỏ tới pixel nguồn và pixel đích
+     */
+    template <class Func>
+    static void transform(Img src, cv::Mat& dst, Func func) {
+        for (int i = 0; i < src.rows; ++i) {
+            const uchar* p = src.ptr<uchar>(i);
+            uchar* q = dst.ptr<uchar>(i);
+            for (int j = 0; j < src.cols; ++j, p += 3, q += 3) {
+                func(p, q);
+            }
+        }
+    }
+};
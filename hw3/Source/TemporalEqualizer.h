@@ -0,0 +1,120 @@
+#pragma once
+#include <queue>
+#include <mutex>
+#include <vector>
+#include <condition_variable>
+#include "IncrementalHistogram.h"
+#include "HistogramEqualizer.h"
+#include "opencv2/core/core.hpp"
+
+// lớp cân bằng histogram theo thời gian cho chuỗi khung hình
+// histogram dùng để cân bằng là trung bình trượt hàm mũ của histogram các khung hình:
+//     H = alpha * H_khung_hiện_tại + (1 - alpha) * H
+// nên bảng tra thay đổi chậm giữa các khung hình liên tiếp, ảnh kết quả không bị nhấp nháy
+// histogram của từng khung hình được cập nhật tăng dần từ khung hình trước bằng IncrementalHistogram
+class TemporalEqualizer {
+    // hệ số làm trơn, 1 nghĩa là chỉ dùng khung hình hiện tại
+    double alpha;
+
+    // histogram của khung hình trước trên mỗi kênh b, g, r
+    IncrementalHistogram hist[3];
+
+    // histogram đã làm trơn trên mỗi kênh, rỗng nếu chưa có khung hình nào
+    std::vector<double> smooth[3];
+
+    // bản sao khung hình trước (trước khi cân bằng)
+    cv::Mat prev;
+public:
+    /**
+     * hàm khởi tạo
+     * @alpha: hệ số làm trơn trong (0, 1]
+     */
+    TemporalEqualizer(double alpha = 0.1) : alpha(alpha),
+        hist{IncrementalHistogram(256, 256, 0), IncrementalHistogram(256, 256, 1), IncrementalHistogram(256, 256, 2)} {
+        if (alpha <= 0 || alpha > 1) {
+            throw std::runtime_error("He so lam tron phai nam trong (0, 1]");
+        }
+    }
+
+    /**
+     * phương thức cân bằng một khung hình, khung hình được ghi đè kết quả
+     * @frame: khung hình CV_8UC3
+     * @return: *this
+     */
+    TemporalEqualizer& apply(cv::Mat& frame) {
+        // khung hình đầu tiên hoặc đổi kích thước: đếm lại từ đầu, ngược lại chỉ cập nhật pixel thay đổi
+        bool restart = prev.empty() || prev.size() != frame.size();
+        for (int c = 0; c < 3; ++c) {
+            if (restart) {
+                hist[c].clear().addRect(frame, cv::Rect(0, 0, frame.cols, frame.rows));
+            }
+            else {
+                hist[c].update(prev, frame);
+            }
+        }
+        frame.copyTo(prev);
+
+        std::vector<uchar> luts[3];
+        for (int c = 0; c < 3; ++c) {
+            auto h = hist[c].getHist();
+            if (restart || smooth[c].empty()) {
+                smooth[c] = h;
+            }
+            else {
+                for (size_t v = 0; v < h.size(); ++v) {
+                    smooth[c][v] = alpha * h[v] + (1 - alpha) * smooth[c][v];
+                }
+            }
+            luts[c] = HistogramEqualizer(smooth[c], 256).getLUT();
+        }
+        HistogramEqualizer::remap(frame, luts);
+
+        return *this;
+    }
+};
+
+// hàng đợi khung hình có giới hạn dùng để nối các luồng đọc -> cân bằng -> ghi
+// luồng trước bị chặn khi hàng đợi đầy nên số khung hình nằm trong bộ nhớ luôn bị chặn trên
+// đóng hàng đợi đánh thức mọi luồng đang chờ, kể cả luồng đang đẩy, nên một luồng gặp lỗi có thể dừng cả chuỗi
+class FrameQueue {
+    std::queue<cv::Mat> frames;
+    size_t capacity;
+    bool closed = false;
+    std::mutex mtx;
+    std::condition_variable not_empty, not_full;
+public:
+    FrameQueue(size_t capacity = 4) : capacity(capacity) {}
+
+    // đẩy một khung hình vào hàng đợi, chờ nếu hàng đợi đầy; trả về false (bỏ khung hình) nếu hàng đợi đã đóng
+    bool push(const cv::Mat& frame) {
+        std::unique_lock<std::mutex> lock(mtx);
+        not_full.wait(lock, [&] { return frames.size() < capacity || closed; });
+        if (closed) {
+            return false;
+        }
+        frames.push(frame);
+        not_empty.notify_one();
+        return true;
+    }
+
+    // lấy một khung hình ra, trả về false nếu hàng đợi đã đóng và không còn khung hình nào
+    bool pop(cv::Mat& frame) {
+        std::unique_lock<std::mutex> lock(mtx);
+        not_empty.wait(lock, [&] { return !frames.empty() || closed; });
+        if (frames.empty()) {
+            return false;
+        }
+        frame = frames.front();
+        frames.pop();
+        not_full.notify_one();
+        return true;
+    }
+
+    // đánh dấu không còn khung hình nào được đẩy vào nữa
+    void close() {
+        std::lock_guard<std::mutex> lock(mtx);
+        closed = true;
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+};
@@ -2,13 +2,22 @@
 #include <iostream>
 #include <tuple>
 #include <cassert>
+#include <thread>
+#include <exception>
+#include "ImageUtils.hpp"
 #include "Histogram.h"
 #include "HistogramDrawer.h"
 #include "HistogramComparator.h"
 #include "HistogramEqualizer.h"
+#include "IncrementalHistogram.h"
+#include "HsvConverter.h"
+#include "ClaheEqualizer.h"
+#include "TemporalEqualizer.h"
+#include "LumaEqualizer.h"
 #include "opencv2/core/core.hpp"
 #include "opencv2/highgui/highgui.hpp" // cần các hàm cv::imread, cv::imwrite, cv::imshow, cv::waitKey, cv::namedWindow
 #include "opencv2/imgproc/imgproc.hpp" // cần hàm cvtColor
+#include "opencv2/videoio/videoio.hpp" // cần cv::VideoCapture, cv::VideoWriter
 
 const int HIS_WIDTH = 640;
 const int HIS_HEIGHT = 480;
@@ -25,29 +34,6 @@ typedef const cv::Mat& Img;
 // https://docs.opencv.org/3.1.0/de/d25/imgproc_color_conversions.html
 const double coeff[] = {0.114, 0.587, 0.299};
 
-/**
- * hàm kiểm tra ảnh có phải ảnh xám hay không
- * @img: ảnh cần kiểm tra
- * return: true nếu @img là ảnh xám, ngược lại false
- **/
-bool is_grayscale(Img img) {
-    // duyệt từng pixel (i, j) trong ảnh
-    for (int i = 0; i < img.rows; ++i) {
-        for (int j = 0; j < img.cols; ++j) {
-            // lấy thông tin 3 kênh màu Red, Blue, Green của ảnh
-            cv::Vec3b pixel = img.at<cv::Vec3b>(i, j);
-            auto R = pixel[2], G = pixel[1], B = pixel[0];
-
-            // ảnh là ảnh xám nếu R = G = B, ngược lại là ảnh màu
-            if (R != G || G != B) {
-                return false;
-            }
-        }
-    }
-
-    return true;
-}
-
 // hàm chuyển ảnh thành ảnh xám
 // @img: ảnh cần chuyển
 // return: ảnh màu xám tương ứng
@@ -92,39 +78,156 @@ cv::Mat get_gray_histogram(Img img, int num_bins) {
     return res;
 }
 
+/**
+ * hàm cân bằng histogram ảnh xám, ghi đè kết quả lên chính ảnh đầu vào
+ * bảng cân bằng được tính xong trước khi ảnh bị ghi đè nên không cần ảnh tạm
+ * @img: ảnh cần cân bằng
+ */
+void hqgray_inplace(cv::Mat& img) {
+    // nếu không phải ảnh xám thì báo lỗi
+    if (!is_grayscale(img)) {
+        throw std::runtime_error("Khong phai anh xam");
+    }
+    // tính histogram và cân bằng
+    HistogramEqualizer he(Histogram().calculate(img, 0));
+    if (img.channels() == 1) {
+        he.apply(img, 0);
+    }
+    else {
+        he.apply(img, {0, 1, 2});
+    }
+}
+
+/**
+ * hàm cân bằng histogram ảnh xám vào ảnh cho trước
+ * @img: ảnh cần câng bằng
+ * @dst: ảnh kết quả, được tạo lại nếu chưa đúng kích thước; có thể trùng @img
+ */
+void hqgray(Img img, cv::Mat& dst) {
+    if (img.data != dst.data) {
+        (overlaps(img, dst) ? img.clone() : img).copyTo(dst);
+    }
+    hqgray_inplace(dst);
+}
+
 /**
  * hàm cân bằng histogram ảnh xám
  * @img: ảnh cần câng bằng
  * @return: ảnh đã được cân bằng
  */
 cv::Mat hqgray(Img img) {
+    cv::Mat res;
+    hqgray(img, res);
+
+    return res;
+}
+
+/**
+ * hàm cân bằng histogram cục bộ ảnh xám: mỗi pixel được cân bằng theo histogram của cửa sổ @win x @win quanh nó
+ * cửa sổ được duyệt theo hình zigzag (dòng chẵn sang phải, dòng lẻ sang trái), mỗi bước chỉ thêm/bớt một cột hoặc một dòng
+ * của cửa sổ vào IncrementalHistogram, nên chi phí mỗi pixel là O(@win) thay vì O(@win ^ 2)
+ * cửa sổ ở biên ảnh bị cắt theo biên
+ * @img: ảnh xám cần cân bằng
+ * @win: kích thước cửa sổ, số lẻ
+ * @return: ảnh đã được cân bằng
+ */
+cv::Mat hqlocal(Img img, int win) {
     // nếu không phải ảnh xám thì báo lỗi
     if (!is_grayscale(img)) {
         throw std::runtime_error("Khong phai anh xam");
     }
-    // tính histogram và cân bằng
-    HistogramEqualizer he(Histogram().calculate(img, 0));
 
-    // tạo ảnh kết quả
     auto res = img.clone();
-    he.apply(res, 0)
-      .apply(res, 1)
-      .apply(res, 2);
+    int r = win / 2;
+    IncrementalHistogram h;
+
+    // đoạn dòng/cột của cửa sổ tâm (i, j), đã cắt theo biên
+    auto row_begin = [&] (int i) { return std::max(0, i - r); };
+    auto row_end = [&] (int i) { return std::min(img.rows, i + r + 1); };
+    auto col_begin = [&] (int j) { return std::max(0, j - r); };
+    auto col_end = [&] (int j) { return std::min(img.cols, j + r + 1); };
+
+    // giá trị cân bằng của pixel (i, j) theo histogram cửa sổ hiện tại
+    auto equalize = [&] (int i, int j) {
+        auto& pix = res.at<cv::Vec3b>(i, j);
+        pix = cv::Vec3b::all(cv::saturate_cast<uchar>(255.0 * h.rank(pix[0]) / h.getTotal()));
+    };
+
+    // cửa sổ đầu tiên tâm (0, 0)
+    h.addRect(img, cv::Rect(0, 0, col_end(0), row_end(0)));
+
+    int j = 0;
+    for (int i = 0; i < img.rows; ++i) {
+        if (i > 0) {
+            // dời cửa sổ xuống một dòng: bớt dòng trên cùng, thêm dòng mới ở dưới
+            if (i - r - 1 >= 0) {
+                h.removeRow(img, i - r - 1, col_begin(j), col_end(j));
+            }
+            if (i + r < img.rows) {
+                h.addRow(img, i + r, col_begin(j), col_end(j));
+            }
+        }
+
+        // hướng duyệt của dòng: dòng chẵn sang phải, dòng lẻ sang trái
+        int dir = i % 2 == 0 ? 1 : -1;
+        while (true) {
+            equalize(i, j);
+            if (j + dir < 0 || j + dir >= img.cols) {
+                break;
+            }
+
+            // dời cửa sổ sang ngang một cột
+            int old_col = dir > 0 ? j - r : j + r;
+            int new_col = dir > 0 ? j + r + 1 : j - r - 1;
+            if (old_col >= 0 && old_col < img.cols) {
+                h.removeCol(img, old_col, row_begin(i), row_end(i));
+            }
+            if (new_col >= 0 && new_col < img.cols) {
+                h.addCol(img, new_col, row_begin(i), row_end(i));
+            }
+            j += dir;
+        }
+    }
 
     return res;
 }
 
+/**
+ * hàm cân bằng 3 kênh độc lập của ảnh rgb, ghi đè kết quả lên chính ảnh đầu vào
+ * @img: ảnh cần cân bằng
+ */
+void hqrgb_inplace(cv::Mat& img) {
+    if (img.type() != CV_8UC3) {
+        throw std::runtime_error("Khong phai anh mau 3 kenh");
+    }
+    // tính bảng tra của từng kênh rồi biến đổi cả 3 kênh trong một lần duyệt ảnh
+    std::vector<uchar> luts[3];
+    for (int c = 0; c < 3; ++c) {
+        luts[c] = HistogramEqualizer(Histogram(256).calculate(img, c)).getLUT();
+    }
+    HistogramEqualizer::remap(img, luts);
+}
+
+/**
+ * hàm cân bằng 3 kênh độc lập của ảnh rgb vào ảnh cho trước
+ * @img: ảnh cần cân bằng
+ * @dst: ảnh kết quả, được tạo lại nếu chưa đúng kích thước; có thể trùng @img
+ */
+void hqrgb(Img img, cv::Mat& dst) {
+    if (img.data != dst.data) {
+        (overlaps(img, dst) ? img.clone() : img).copyTo(dst);
+    }
+    hqrgb_inplace(dst);
+}
+
 /**
  * hàm cân bằng 3 kênh độc lập của ảnh rgb
  * @img: ảnh cần cân bằng
  * @return: ảnh đã cân bằng
  */
 cv::Mat hqrgb(Img img) {
-    auto res = img.clone();
-
-    for (int c = 0; c < img.channels(); ++c) {
-        HistogramEqualizer(Histogram(256).calculate(img, c)).apply(res, c);
-    }
+    cv::Mat res;
+    hqrgb(img, res);
 
     return res;
 }
@@ -228,19 +331,338 @@ cv::Mat map_pixels(Img img, Func func) {
     return res;
 }
 
+// số dòng được chuyển sang hsv mỗi lần khi tính histogram kênh h trong hqhsv
+const int HSV_CHUNK_ROWS = 16;
+
+/**
+ * hàm cân bằng kênh h của ảnh
+ * ảnh hsv đầy đủ không bao giờ được tạo ra, chỉ cần ảnh kết quả và một bộ đệm vài dòng:
+ * - lượt 1: chuyển từng cụm HSV_CHUNK_ROWS dòng sang hsv vào bộ đệm, chỉ để đếm histogram kênh h
+ * - lượt 2: với mỗi dòng, chuyển sang hsv, tra bảng cân bằng kênh h rồi chuyển ngược về bgr ghi thẳng vào ảnh kết quả
+ * @src: ảnh cần cân bằng
+ * @dst: ảnh kết quả, được tạo lại nếu chưa đúng kích thước; có thể trùng @src vì mỗi dòng chỉ được ghi sau khi đã đọc
+ */
+void hqhsv(Img src, cv::Mat& dst) {
+    cv::Mat rgb_img = overlaps(src, dst) && src.data != dst.data ? src.clone() : src;
+
+    // chuyển đổi bằng số nguyên thay cho rgb_to_hsv/hsv_to_rgb trên từng pixel, sai lệch không quá 1 mức
+    HsvConverter conv;
+    cv::Mat chunk(std::min(HSV_CHUNK_ROWS, rgb_img.rows), rgb_img.cols, CV_8UC3);
+
+    // lượt 1: histogram kênh h với 180 bin
+    IncrementalHistogram hist(180, 180, 0);
+    for (int i = 0; i < rgb_img.rows; i += chunk.rows) {
+        int n = std::min(chunk.rows, rgb_img.rows - i);
+        for (int k = 0; k < n; ++k) {
+            conv.bgrToHsvRow(rgb_img.ptr<uchar>(i + k), chunk.ptr<uchar>(k), rgb_img.cols);
+        }
+        hist.addRect(chunk, cv::Rect(0, 0, rgb_img.cols, n));
+    }
+    auto lut = HistogramEqualizer(hist.getHist(), 180).getLUT();
+
+    // lượt 2: chuyển đổi, cân bằng kênh h và chuyển ngược từng dòng, dùng dòng đầu của bộ đệm
+    dst.create(rgb_img.size(), CV_8UC3);
+    uchar* buf = chunk.ptr<uchar>(0);
+    for (int i = 0; i < rgb_img.rows; ++i) {
+        conv.bgrToHsvRow(rgb_img.ptr<uchar>(i), buf, rgb_img.cols);
+        for (int j = 0; j < rgb_img.cols; ++j) {
+            buf[j * 3] = lut[buf[j * 3]];
+        }
+        conv.hsvToBgrRow(buf, dst.ptr<uchar>(i), rgb_img.cols);
+    }
+}
+
 /**
  * hàm cân bằng kênh h của ảnh
  * @img: ảnh cần cân bằng
  * @return: ảnh đã được cân bằng kênh h
  */
-cv::Mat hqhsv(Img rgb_img) {
-    auto hsv_img = map_pixels(rgb_img, rgb_to_hsv);
+cv::Mat hqhsv(Img img) {
+    cv::Mat res;
+    hqhsv(img, res);
+    return res;
+}
 
-    // cân bằng kênh h với 180 bin
-    HistogramEqualizer(Histogram(180, 180).calculate(hsv_img, 0)).apply(hsv_img, 0);
+/**
+ * hàm tính sai lệch lớn nhất trên mỗi kênh giữa 2 ảnh 3 kênh cùng kích thước
+ * @a, @b: 2 ảnh cần so sánh
+ * @return: sai lệch lớn nhất của từng kênh
+ */
+cv::Vec3i max_channel_error(Img a, Img b) {
+    cv::Vec3i err(0, 0, 0);
+    for (int i = 0; i < a.rows; ++i) {
+        auto p = a.ptr<cv::Vec3b>(i);
+        auto q = b.ptr<cv::Vec3b>(i);
+        for (int j = 0; j < a.cols; ++j) {
+            for (int c = 0; c < 3; ++c) {
+                err[c] = std::max(err[c], std::abs(p[j][c] - q[j][c]));
+            }
+        }
+    }
+    return err;
+}
 
-    // chuyển từ hệ hsv sang rgb và trả ra kết quả
-    return map_pixels(hsv_img, hsv_to_rgb);
+/**
+ * hàm đo thời gian chạy trung bình của một thao tác
+ * @func: thao tác cần đo
+ * @runs: số lần chạy
+ * @return: thời gian trung bình (ms)
+ */
+template <class Func>
+double time_ms(Func func, int runs) {
+    auto start = cv::getTickCount();
+    for (int k = 0; k < runs; ++k) {
+        func();
+    }
+    return (cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency() / runs;
+}
+
+/**
+ * hàm kiểm tra sai số và đo tốc độ của HsvConverter so với các hàm tham chiếu rgb_to_hsv, hsv_to_rgb và cv::cvtColor
+ * kết quả được in ra @out
+ * @img: ảnh màu dùng để kiểm tra
+ * @runs: số lần chạy mỗi cách để lấy thời gian trung bình
+ * @out: luồng xuất kết quả
+ */
+void benchmark_hsv(Img img, int runs, std::ostream& out) {
+    HsvConverter conv;
+    cv::Mat ref_hsv, fast_hsv, cv_hsv, ref_bgr, fast_bgr, cv_bgr;
+
+    double ref_fwd = time_ms([&] { ref_hsv = map_pixels(img, rgb_to_hsv); }, runs);
+    double fast_fwd = time_ms([&] { fast_hsv = conv.bgrToHsv(img); }, runs);
+    double cv_fwd = time_ms([&] { cv::cvtColor(img, cv_hsv, cv::COLOR_BGR2HSV); }, runs);
+
+    // chiều ngược lại dùng chung đầu vào là kết quả của hàm tham chiếu để chỉ đo sai số của riêng bước này
+    double ref_bwd = time_ms([&] { ref_bgr = map_pixels(ref_hsv, hsv_to_rgb); }, runs);
+    double fast_bwd = time_ms([&] { fast_bgr = conv.hsvToBgr(ref_hsv); }, runs);
+    double cv_bwd = time_ms([&] { cv::cvtColor(ref_hsv, cv_bgr, cv::COLOR_HSV2BGR); }, runs);
+
+    auto fwd_err = max_channel_error(ref_hsv, fast_hsv);
+    auto bwd_err = max_channel_error(ref_bgr, fast_bgr);
+
+    out << "image " << img.cols << "x" << img.rows << ", " << runs << " runs\n";
+    out << "bgr -> hsv: reference " << ref_fwd << " ms, integer " << fast_fwd << " ms, cvtColor " << cv_fwd << " ms\n";
+    out << "hsv -> bgr: reference " << ref_bwd << " ms, integer " << fast_bwd << " ms, cvtColor " << cv_bwd << " ms\n";
+    out << "max error bgr -> hsv (h, s, v): " << fwd_err[0] << ", " << fwd_err[1] << ", " << fwd_err[2] << "\n";
+    out << "max error hsv -> bgr (b, g, r): " << bwd_err[0] << ", " << bwd_err[1] << ", " << bwd_err[2] << "\n";
+}
+
+/**
+ * hàm cân bằng histogram thích nghi có giới hạn độ tương phản (CLAHE)
+ * ảnh xám chỉ xử lý một kênh, ảnh màu xử lý độc lập từng kênh b, g, r như hqrgb
+ * @img: ảnh cần cân bằng
+ * @grid: số ô theo chiều ngang và chiều dọc
+ * @clip_limit: ngưỡng cắt histogram của mỗi ô
+ * @dst: ảnh kết quả, được tạo lại nếu chưa đúng kích thước; có thể trùng @img vì các kênh đã được tách ra trước
+ */
+void hqclahe(Img img, cv::Size grid, double clip_limit, cv::Mat& dst) {
+    ClaheEqualizer clahe(grid, clip_limit);
+
+    cv::Mat bgr[3];
+    cv::split(img, bgr);
+    if (is_grayscale(img)) {
+        clahe.apply(bgr[0], bgr[0]);
+        bgr[1] = bgr[2] = bgr[0];
+    }
+    else {
+        for (int c : {0, 1, 2}) {
+            clahe.apply(bgr[c], bgr[c]);
+        }
+    }
+
+    cv::merge(bgr, 3, dst);
+}
+
+/**
+ * hàm cân bằng histogram thích nghi có giới hạn độ tương phản (CLAHE)
+ * @img: ảnh cần cân bằng
+ * @grid: số ô theo chiều ngang và chiều dọc
+ * @clip_limit: ngưỡng cắt histogram của mỗi ô
+ * @return: ảnh đã được cân bằng
+ */
+cv::Mat hqclahe(Img img, cv::Size grid, double clip_limit) {
+    cv::Mat res;
+    hqclahe(img, grid, clip_limit, res);
+    return res;
+}
+
+/**
+ * hàm cân bằng CLAHE sử dụng opencv, xử lý giống hqclahe
+ * @img: ảnh cần cân bằng
+ * @grid: số ô theo chiều ngang và chiều dọc
+ * @clip_limit: ngưỡng cắt histogram của mỗi ô
+ * @return: ảnh đã được cân bằng
+ */
+cv::Mat hqclahe_opencv(Img img, cv::Size grid, double clip_limit) {
+    auto clahe = cv::createCLAHE(clip_limit, grid);
+
+    cv::Mat bgr[3];
+    cv::split(img, bgr);
+    if (is_grayscale(img)) {
+        clahe->apply(bgr[0], bgr[0]);
+        bgr[1] = bgr[2] = bgr[0];
+    }
+    else {
+        for (int c : {0, 1, 2}) {
+            clahe->apply(bgr[c], bgr[c]);
+        }
+    }
+
+    cv::Mat res;
+    cv::merge(bgr, 3, res);
+    return res;
+}
+
+/**
+ * hàm cân bằng histogram theo thời gian cho video hoặc chuỗi ảnh
+ * 3 công đoạn chạy trên 3 luồng nối với nhau bằng hàng đợi có giới hạn:
+ * đọc khung hình -> cân bằng bằng TemporalEqualizer -> ghi khung hình
+ * @in_path: đường dẫn video, hoặc mẫu tên chuỗi ảnh kiểu img_%03d.png
+ * @out_path: đường dẫn video kết quả (MJPG)
+ * @alpha: hệ số làm trơn histogram giữa các khung hình
+ * @return: số khung hình đã xử lý
+ */
+int hqvideo(const std::string& in_path, const std::string& out_path, double alpha) {
+    cv::VideoCapture cap(in_path);
+    if (!cap.isOpened()) {
+        throw std::runtime_error("Khong mo duoc video " + in_path);
+    }
+
+    // chuỗi ảnh thường không có thông tin fps
+    double fps = cap.get(cv::CAP_PROP_FPS);
+    if (fps <= 0) {
+        fps = 25;
+    }
+
+    TemporalEqualizer equalizer(alpha);
+    FrameQueue decoded, equalized;
+
+    // lỗi của từng luồng; luồng gặp lỗi đóng cả 2 hàng đợi để các luồng còn lại thoát ra thay vì chờ mãi
+    std::exception_ptr decoder_error, worker_error, writer_error;
+    auto stop = [&] {
+        decoded.close();
+        equalized.close();
+    };
+
+    // luồng đọc: mỗi khung hình là một cv::Mat mới vì VideoCapture dùng lại bộ đệm của nó
+    std::thread decoder([&] {
+        try {
+            for (;;) {
+                cv::Mat frame;
+                if (!cap.read(frame) || frame.empty() || !decoded.push(frame)) {
+                    break;
+                }
+            }
+            decoded.close();
+        }
+        catch (...) {
+            decoder_error = std::current_exception();
+            stop();
+        }
+    });
+
+    // luồng cân bằng: ghi đè kết quả lên chính khung hình
+    std::thread worker([&] {
+        try {
+            cv::Mat frame;
+            while (decoded.pop(frame)) {
+                equalizer.apply(frame);
+                if (!equalized.push(frame)) {
+                    break;
+                }
+            }
+            equalized.close();
+        }
+        catch (...) {
+            worker_error = std::current_exception();
+            stop();
+        }
+    });
+
+    // luồng hiện tại ghi video, mở VideoWriter khi biết kích thước khung hình đầu tiên
+    int count = 0;
+    try {
+        cv::VideoWriter writer;
+        cv::Size size;
+        cv::Mat frame;
+        while (equalized.pop(frame)) {
+            if (!writer.isOpened()) {
+                size = frame.size();
+                writer.open(out_path, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), fps, size);
+                if (!writer.isOpened()) {
+                    throw std::runtime_error("Khong mo duoc video ket qua " + out_path);
+                }
+            }
+            if (frame.size() != size) {
+                throw std::runtime_error("Khung hinh " + std::to_string(count) + " khac kich thuoc khung hinh dau tien");
+            }
+            writer << frame;
+            ++count;
+        }
+    }
+    catch (...) {
+        writer_error = std::current_exception();
+        stop();
+    }
+
+    // luôn chờ cả 2 luồng kết thúc trước khi trả về hoặc ném lỗi
+    decoder.join();
+    worker.join();
+    for (auto& error : {writer_error, decoder_error, worker_error}) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    return count;
+}
+
+/**
+ * hàm cân bằng histogram chỉ trên kênh độ sáng, giữ nguyên màu sắc, vào ảnh cho trước
+ * @img: ảnh cần cân bằng
+ * @mode: kênh độ sáng LUMA_V, LUMA_Y hoặc LUMA_L
+ * @dst: ảnh kết quả, được tạo lại nếu chưa đúng kích thước; có thể trùng @img
+ */
+void hqluma(Img img, const std::string& mode, cv::Mat& dst) {
+    LumaEqualizer(mode).apply(img, dst);
+}
+
+/**
+ * hàm cân bằng histogram chỉ trên kênh độ sáng, giữ nguyên màu sắc
+ * @img: ảnh cần cân bằng
+ * @mode: kênh độ sáng LUMA_V, LUMA_Y hoặc LUMA_L
+ * @return: ảnh đã được cân bằng
+ */
+cv::Mat hqluma(Img img, const std::string& mode) {
+    cv::Mat res;
+    hqluma(img, mode, res);
+    return res;
+}
+
+/**
+ * hàm cân bằng kênh độ sáng sử dụng opencv: chuyển hệ màu, cân bằng một kênh rồi chuyển ngược
+ * @img: ảnh cần cân bằng
+ * @mode: kênh độ sáng LUMA_V, LUMA_Y hoặc LUMA_L
+ * @return: ảnh đã được cân bằng
+ */
+cv::Mat hqluma_opencv(Img img, const std::string& mode) {
+    int to, from, channel;
+    if (mode == LUMA_V) {
+        to = cv::COLOR_BGR2HSV, from = cv::COLOR_HSV2BGR, channel = 2;
+    }
+    else if (mode == LUMA_Y) {
+        to = cv::COLOR_BGR2YCrCb, from = cv::COLOR_YCrCb2BGR, channel = 0;
+    }
+    else {
+        to = cv::COLOR_BGR2Lab, from = cv::COLOR_Lab2BGR, channel = 0;
+    }
+
+    cv::Mat converted, planes[3], res;
+    cv::cvtColor(img, converted, to);
+    cv::split(converted, planes);
+    cv::equalizeHist(planes[channel], planes[channel]);
+    cv::merge(planes, 3, converted);
+    cv::cvtColor(converted, res, from);
+    return res;
 }
 
 /**
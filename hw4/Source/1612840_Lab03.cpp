@@ -3,6 +3,7 @@
 #include <iostream>                    // cần std::cerr, std::endl
 #include "algos.h"                     // định nghĩa các hàm chức năng xử lý trên ảnh
 #include <map>
+#include <sstream>
 #include "opencv2/highgui/highgui.hpp" // cần các hàm cv::imread, cv::imwrite, cv::imshow, cv::waitKey, cv::namedWindow
 #include "opencv2/imgproc/imgproc.hpp" // cần hàm cvtColor
 #ifdef BDBG
@@ -12,6 +13,12 @@
 #define CMD_ROTATE    "rotate"  // mã lệnh xoay ảnh bảo toàn
 #define CMD_ROTATE_N  "rotateN" // mã lệnh xoay ảnh không bảo toàn
 #define CMD_SCALE     "scale"   // mã lệnh thay đổi kích thước ảnh
+#define CMD_PLAN      "plan"    // mã lệnh thực hiện một chuỗi phép biến đổi chỉ với một lần lấy mẫu
+#define CMD_KEYSTONE  "keystone" // mã lệnh chỉnh méo phối cảnh
+#define CMD_RESIZE    "resize"  // mã lệnh thay đổi kích thước ảnh bằng bộ lọc tách được
+#define CMD_RESIZEBENCH "resizebench" // mã lệnh đo tốc độ resize so với cv::resize
+#define CMD_FLIP      "flip"    // mã lệnh lật ảnh
+#define CMD_TRANSPOSE "transpose" // mã lệnh chuyển vị ảnh
 #define CMD_SHOW_HELP "help"    // mã lệnh hiện hướng dẫn
 
 typedef const cv::CommandLineParser& Params;
@@ -29,6 +36,15 @@ auto read_img(Params params) {
     return cv::imread(fname);
 }
 
+/**
+ * hàm đọc cách nội suy và kiểu biên từ param parser
+ * @params: param parser
+ * @return: sampler tương ứng
+ */
+Sampler read_sampler(Params params) {
+    return Sampler(params.get<std::string>("interp"), params.get<std::string>("border"));
+}
+
 /**
  * hàm xuất ảnh ra màn hình
  * @img: ảnh cần xuất
@@ -58,7 +74,7 @@ void rotate(Params param) {
     auto phi = param.get<double>("@arg1") * PI / 180;
 
     // tính ảnh kết quả
-    auto res = rotate(img, phi);
+    auto res = rotate(img, phi, read_sampler(param));
 
     // xuất ảnh đầu vào ra màn hình
     show_image(img, "input");
@@ -78,7 +94,7 @@ void rotateN(Params param) {
     auto phi = param.get<double>("@arg1") * PI / 180;
 
     // tính ảnh kết quả
-    auto res = rotateN(img, phi);
+    auto res = rotateN(img, phi, read_sampler(param));
 
     // xuất ảnh đầu vào ra màn hình
     show_image(img, "input");
@@ -99,13 +115,157 @@ void scale(Params param) {
     auto yscale = param.get<double>("@arg2");
 
     // tính ảnh kết quả
-    auto res = scale(img, xscale, yscale);
+    auto res = scale(img, xscale, yscale, read_sampler(param));
+
+    // xuất ảnh đầu vào ra màn hình
+    show_image(img, "input");
+    // xuất ảnh kết quả ra màn hình
+    show_image(res, "student's result");
+}
+
+/**
+ * hàm thực hiện chuỗi phép biến đổi lấy từ param parser
+ * các bước được gộp thành một ma trận nên ảnh chỉ bị lấy mẫu lại một lần
+ * @param: param parser
+ */
+void plan(Params param) {
+    // lấy ảnh từ param parser
+    auto img = read_img(param);
+
+    // lập kế hoạch từ chuỗi các bước
+    auto warp_plan = WarpPlan::parse(param.get<std::string>("steps"), img.size());
+    auto sampler = read_sampler(param);
+
+    // thực thi, hoặc lặp lại nhiều lần như trên một chuỗi khung hình: lần đầu tính bảng ánh xạ,
+    // các lần sau chỉ đọc lại bảng
+    cv::Mat res;
+    int repeat = param.get<int>("repeat");
+    if (repeat <= 1) {
+        res = warp_plan.execute(img, sampler);
+    }
+    else {
+        RemapCache cache;
+        for (int i = 0; i < repeat; ++i) {
+            auto start = cv::getTickCount();
+            res = warp_plan.execute(img, cache, sampler);
+            std::cout << "frame " << i << ": " << (cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency() << " ms" << std::endl;
+        }
+    }
+
+    // xuất ảnh đầu vào ra màn hình
+    show_image(img, "input");
+    // xuất ảnh kết quả ra màn hình
+    show_image(res, "student's result");
+}
+/**
+ * hàm chỉnh méo phối cảnh lấy từ param parser
+ * 4 góc của vùng cần chỉnh có dạng "x1,y1;x2,y2;x3,y3;x4,y4" (x là dòng, y là cột),
+ * theo thứ tự trên trái, trên phải, dưới phải, dưới trái
+ * @param: param parser
+ */
+void keystone(Params param) {
+    // lấy ảnh từ param parser
+    auto img = read_img(param);
+
+    // đọc 4 góc
+    cv::Point2d corners[4];
+    std::stringstream ss(param.get<std::string>("corners"));
+    std::string corner;
+    int n = 0;
+    while (std::getline(ss, corner, ';')) {
+        auto comma = corner.find(',');
+        if (n == 4 || comma == std::string::npos) {
+            throw std::runtime_error("Can dung 4 goc dang x,y");
+        }
+        corners[n++] = cv::Point2d(std::stod(corner.substr(0, comma)), std::stod(corner.substr(comma + 1)));
+    }
+    if (n != 4) {
+        throw std::runtime_error("Can dung 4 goc dang x,y");
+    }
+
+    // lấy kích thước ảnh kết quả, 0 nghĩa là tự tính theo 4 góc
+    auto height = (int)param.get<double>("@arg1");
+    auto width = (int)param.get<double>("@arg2");
+
+    // tính ảnh kết quả
+    auto res = keystone(img, corners, height, width, read_sampler(param));
 
     // xuất ảnh đầu vào ra màn hình
     show_image(img, "input");
     // xuất ảnh kết quả ra màn hình
     show_image(res, "student's result");
 }
+
+/**
+ * hàm thay đổi kích thước ảnh bằng bộ lọc tách được lấy từ param parser
+ * @param: param parser
+ */
+void resize(Params param) {
+    // lấy ảnh từ param parser
+    auto img = read_img(param);
+
+    // lấy tham số tỉ lệ thay đổi theo trục x và y
+    auto xscale = param.get<double>("@arg1");
+    auto yscale = param.get<double>("@arg2");
+
+    // tính ảnh kết quả
+    auto res = resize(img, xscale, yscale, param.get<std::string>("kernel"));
+
+    // xuất ảnh đầu vào ra màn hình
+    show_image(img, "input");
+    // xuất ảnh kết quả ra màn hình
+    show_image(res, "student's result");
+}
+
+/**
+ * hàm đo tốc độ resize lấy từ param parser
+ * @param: param parser
+ */
+void resizebench(Params param) {
+    // lấy ảnh từ param parser
+    auto img = read_img(param);
+
+    // lấy tham số tỉ lệ thay đổi theo trục x và y
+    auto xscale = param.get<double>("@arg1");
+    auto yscale = param.get<double>("@arg2");
+
+    benchmark_resize(img, xscale, yscale, param.get<int>("runs"), std::cout);
+}
+
+/**
+ * hàm lật ảnh lấy từ param parser
+ * @param: param parser
+ */
+void flip(Params param) {
+    // lấy ảnh từ param parser
+    auto img = read_img(param);
+
+    // tính ảnh kết quả
+    auto res = Transposer::flip(img, param.get<std::string>("axis"));
+
+    // xuất ảnh đầu vào ra màn hình
+    show_image(img, "input");
+    // xuất ảnh kết quả ra màn hình
+    show_image(res, "student's result");
+}
+
+/**
+ * hàm chuyển vị ảnh lấy từ param parser
+ * @param: param parser
+ */
+void transpose(Params param) {
+    // lấy ảnh từ param parser
+    auto img = read_img(param);
+
+    // tính ảnh kết quả
+    auto res = Transposer::transpose(img);
+
+    // xuất ảnh đầu vào ra màn hình
+    show_image(img, "input");
+    // xuất ảnh kết quả ra màn hình
+    show_image(res, "student's result");
+}
+
 typedef void (*cmd_func)(const cv::CommandLineParser&);
 
 // bảng ánh xạ từ chuỗi mã lệnh tới hàm xử lý tương ứng dựa vào param parser
@@ -114,6 +274,12 @@ std::map<std::string, cmd_func> commands =
     {CMD_ROTATE, rotate},
     {CMD_ROTATE_N, rotateN},
     {CMD_SCALE, scale},
+    {CMD_PLAN, plan},
+    {CMD_KEYSTONE, keystone},
+    {CMD_RESIZE, resize},
+    {CMD_RESIZEBENCH, resizebench},
+    {CMD_FLIP, flip},
+    {CMD_TRANSPOSE, transpose},
     {CMD_SHOW_HELP, show_help}
 };
 
@@ -130,9 +296,23 @@ auto parseParams(int nargs, char* args[]) {
         "{" CMD_ROTATE                  "|   | rotate image with preservation}"
         "{" CMD_ROTATE_N                "|   | rotate image with out preservation}"
         "{" CMD_SCALE                   "|   | scale image}"
-        "{@arg1                          |   | 'phi' for rotate command, or 'xscale' for scale command}"
-        "{@arg2                          |0  | 'yscale' for scale command}"
+        "{" CMD_PLAN                    "|   | apply a sequence of transforms (see steps) with a single resampling}"
+        "{" CMD_KEYSTONE                "|   | rectify the quadrilateral given by corners into a rectangle}"
+        "{" CMD_RESIZE                  "|   | resize image with a separable area or lanczos filter (see kernel)}"
+        "{" CMD_RESIZEBENCH             "|   | compare resize with cv::resize and scale}"
+        "{" CMD_FLIP                    "|   | flip image (see axis)}"
+        "{" CMD_TRANSPOSE               "|   | transpose image}"
+        "{@arg1                          |   | 'phi' for rotate command, 'xscale' for scale/resize commands, or 'height' for keystone command}"
+        "{@arg2                          |0  | 'yscale' for scale/resize commands, or 'width' for keystone command}"
         "{" CMD_SHOW_HELP               "|   | show help}"
+        "{interp                         |bilinear| interpolation: nearest, bilinear, bicubic}"
+        "{border                         |constant| border mode: constant, replicate, reflect}"
+        "{steps                          |   | transform steps for plan, e.g. scale:2,2;rotate:30;crop:gx,gy,height,width}"
+        "{corners                        |   | keystone corners x,y;x,y;x,y;x,y (row, col), clockwise from top left}"
+        "{axis                           |x  | flip axis: x (reverse rows), y (reverse columns), xy (both)}"
+        "{kernel                         |area| resize filter: area, lanczos}"
+        "{runs                           |10 | number of runs for resizebench}"
+        "{repeat                         |1  | apply plan this many times through a cached remap table, e.g. for video frames}"
         ;
 
     // tạo param parser dựa trên tham số đầu vào và bảng định nghĩa các hàm chức năng
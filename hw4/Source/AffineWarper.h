@@ -0,0 +1,314 @@
+#pragma once
+#include <cmath>
+#include <cfloat>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+#include "Sampler.h"
+#include "ImageUtils.hpp"
+#include "opencv2/core/core.hpp"
+#include "opencv2/core/utility.hpp" // cần hàm cv::parallel_for_
+
+typedef const cv::Mat& Img;
+
+// lớp áp dụng phép biến đổi affine lên ảnh theo từng dòng quét
+// quy ước tọa độ giống applyTransform: x là chỉ số dòng, y là chỉ số cột
+// thay vì nhân ma trận cho mỗi pixel, tọa độ nguồn của pixel đầu mỗi dòng được tính một lần,
+// các pixel sau chỉ cộng thêm một bước cố định (dx, dy) ở dạng số nguyên dấu phẩy tĩnh;
+// tọa độ được cộng dồn trên 64 bit với ACC_BITS bit phần lẻ rồi mới làm tròn về BITS bit của Sampler,
+// nên sai số làm tròn của bước cộng dồn dọc một dòng chỉ cỡ cột * 2^-33 pixel (dưới 2^-16 pixel đến cột 131072)
+// trên mỗi dòng, đoạn pixel có mọi điểm lân cận nằm trong ảnh được tính trước,
+// nên vòng lặp trong đoạn này không cần kiểm tra biên; chỉ vài pixel ở rìa mới đi đường chậm có xử lý biên
+// việc lấy mẫu (gần nhất, song tuyến tính, bậc 3) và kiểu biên do Sampler đảm nhận
+// ảnh kết quả được chia thành các ô TILE x TILE xử lý song song trên thread pool của opencv,
+// vùng ảnh nguồn mà một ô cần đọc cũng chỉ cỡ một ô, nên cả ô nguồn và ô đích đều nằm gọn trong cache
+class AffineWarper {
+    static const int BITS = Sampler::BITS;
+    static const int ONE = Sampler::ONE;
+
+    // số bit phần lẻ của tọa độ cộng dồn
+    static const int ACC_BITS = 32;
+
+    // tọa độ nguồn tuyệt đối lớn nhất (pixel) để tọa độ BITS bit phần lẻ, cả khi cộng các điểm lân cận, vẫn vừa kiểu int
+    static const int COORD_LIMIT = (1 << (31 - BITS)) - 8;
+
+    // kích thước cạnh ô, 128 x 128 pixel CV_8UC3 là 48KB
+    static const int TILE = 128;
+
+    // ma trận 2 x 3 ánh xạ tọa độ (x, y, 1) trên ảnh kết quả về tọa độ trên ảnh nguồn
+    cv::Matx23d inv_map;
+
+    // cách lấy mẫu và kiểu biên
+    Sampler sampler;
+public:
+    /**
+     * hàm khởi tạo từ ánh xạ ngược
+     * @inv_map: ma trận 2 x 3 ánh xạ tọa độ ảnh kết quả về tọa độ ảnh nguồn
+     * @sampler: cách lấy mẫu và kiểu biên
+     */
+    AffineWarper(const cv::Matx23d& inv_map, const Sampler& sampler = Sampler()) : inv_map(inv_map), sampler(sampler) {}
+
+    /**
+     * phương thức tính ảnh kết quả vào ảnh cho trước
+     * @img: ảnh nguồn CV_8UC(n)
+     * @size: kích thước ảnh kết quả
+     * @dst: ảnh kết quả, được tạo lại nếu chưa đúng kích thước; nếu dùng chung vùng nhớ với @img
+     *       thì ảnh nguồn được sao ra trước vì pixel đích đọc pixel nguồn ở vị trí khác
+     */
+    void warp(Img img, cv::Size size, cv::Mat& dst) const {
+        checkRange(img.size(), size);
+        cv::Mat src = overlaps(img, dst) ? img.clone() : img;
+        dst.create(size, src.type());
+        forEachTile(size, [&](const cv::Rect& tile) {
+            warpTile(src, dst, tile);
+        });
+    }
+
+    /**
+     * phương thức tính ảnh kết quả
+     * @src: ảnh nguồn CV_8UC(n)
+     * @size: kích thước ảnh kết quả
+     * @return: ảnh kết quả
+     */
+    cv::Mat warp(Img src, cv::Size size) const {
+        cv::Mat dst;
+        warp(src, size, dst);
+        return dst;
+    }
+
+    /**
+     * phương thức kiểm tra tọa độ dấu phẩy tĩnh của mọi pixel kết quả vừa kiểu int
+     * ánh xạ là affine nên tọa độ nguồn lớn nhất nằm ở 4 góc ảnh kết quả
+     * @src_size: kích thước ảnh nguồn
+     * @size: kích thước ảnh kết quả
+     */
+    void checkRange(cv::Size src_size, cv::Size size) const {
+        checkSource(src_size);
+        for (int i : {0, size.height - 1}) {
+            for (int j : {0, size.width - 1}) {
+                double x = inv_map(0, 0) * i + inv_map(0, 1) * j + inv_map(0, 2);
+                double y = inv_map(1, 0) * i + inv_map(1, 1) * j + inv_map(1, 2);
+                if (!(std::abs(x) < COORD_LIMIT && std::abs(y) < COORD_LIMIT)) {
+                    throw std::runtime_error("Toa do nguon vuot qua gioi han cua phep bien doi");
+                }
+            }
+        }
+    }
+
+    /**
+     * hàm kiểm tra kích thước ảnh nguồn, cùng giới hạn với RemapTable: mọi pixel trong ảnh phải có tọa độ vừa kiểu int
+     * sau khi đổi sang dấu phẩy tĩnh BITS bit phần lẻ
+     * @src_size: kích thước ảnh nguồn
+     */
+    static void checkSource(cv::Size src_size) {
+        if (src_size.width > COORD_LIMIT || src_size.height > COORD_LIMIT) {
+            throw std::runtime_error("Anh nguon qua lon cho phep bien doi");
+        }
+    }
+
+    /**
+     * hàm chia ảnh kích thước @size thành các ô TILE x TILE và gọi @func trên từng ô, song song trên thread pool của opencv
+     * @size: kích thước ảnh
+     * @func: hàm nhận một ô theo quy ước của cv::Rect (x là cột, y là dòng)
+     */
+    template <class Func>
+    static void forEachTile(cv::Size size, Func func) {
+        int tiles_x = (size.width + TILE - 1) / TILE, tiles_y = (size.height + TILE - 1) / TILE;
+        cv::parallel_for_(cv::Range(0, tiles_x * tiles_y), [&](const cv::Range& range) {
+            for (int t = range.start; t < range.end; ++t) {
+                int x = t % tiles_x * TILE, y = t / tiles_x * TILE;
+                int w = size.width - x, h = size.height - y;
+                func(cv::Rect(x, y, w < TILE ? w : TILE, h < TILE ? h : TILE));
+            }
+        });
+    }
+
+    /**
+     * phương thức tính một ô hình chữ nhật của ảnh kết quả
+     * ô có vùng nguồn nằm hẳn ngoài ảnh với biên hằng thì được tô 0 luôn, không cần lấy mẫu
+     * @src: ảnh nguồn
+     * @dst: ảnh kết quả
+     * @tile: ô cần tính, theo quy ước của cv::Rect (x là cột, y là dòng)
+     */
+    void warpTile(Img src, cv::Mat& dst, const cv::Rect& tile) const {
+        if (sampler.getBorder() == Sampler::CONSTANT && (footprint(tile) & cv::Rect(0, 0, src.cols, src.rows)).area() == 0) {
+            dst(tile).setTo(cv::Scalar::all(0));
+            return;
+        }
+        for (int i = tile.y; i < tile.y + tile.height; ++i) {
+            warpRow(src, dst, i, tile.x, tile.x + tile.width);
+        }
+    }
+
+    /**
+     * phương thức tính vùng ảnh nguồn mà một ô của ảnh kết quả cần đọc
+     * vì ánh xạ là affine nên đó là hình bao của ảnh 4 góc ô, nới thêm các điểm lân cận của cách nội suy
+     * @tile: ô trên ảnh kết quả, theo quy ước của cv::Rect
+     * @return: vùng trên ảnh nguồn, theo quy ước của cv::Rect
+     */
+    cv::Rect footprint(const cv::Rect& tile) const {
+        double xmin = DBL_MAX, ymin = DBL_MAX, xmax = -DBL_MAX, ymax = -DBL_MAX;
+        for (int i : {tile.y, tile.y + tile.height - 1}) {
+            for (int j : {tile.x, tile.x + tile.width - 1}) {
+                double x = inv_map(0, 0) * i + inv_map(0, 1) * j + inv_map(0, 2);
+                double y = inv_map(1, 0) * i + inv_map(1, 1) * j + inv_map(1, 2);
+                xmin = std::min(xmin, x), xmax = std::max(xmax, x);
+                ymin = std::min(ymin, y), ymax = std::max(ymax, y);
+            }
+        }
+        int before, after;
+        sampler.margins(before, after);
+        int top = cvFloor(xmin) - before - 1, left = cvFloor(ymin) - before - 1;
+        int bottom = cvFloor(xmax) + after + 1, right = cvFloor(ymax) + after + 1;
+        return cv::Rect(left, top, right - left + 1, bottom - top + 1);
+    }
+
+    /**
+     * phương thức tính một đoạn trên một dòng của ảnh kết quả
+     * @src: ảnh nguồn
+     * @dst: ảnh kết quả
+     * @row: chỉ số dòng trên ảnh kết quả
+     * @col_begin, @col_end: đoạn cột [col_begin, col_end) cần tính
+     */
+    void warpRow(Img src, cv::Mat& dst, int row, int col_begin, int col_end) const {
+        if (col_begin >= col_end) {
+            return;
+        }
+
+        switch (sampler.getInterp()) {
+            case Sampler::NEAREST:
+                scan<Sampler::NEAREST>(src, dst, row, col_begin, col_end);
+                break;
+            case Sampler::BILINEAR:
+                scan<Sampler::BILINEAR>(src, dst, row, col_begin, col_end);
+                break;
+            default:
+                scan<Sampler::BICUBIC>(src, dst, row, col_begin, col_end);
+                break;
+        }
+    }
+
+    /**
+     * phương thức tính tọa độ nguồn cộng dồn (ACC_BITS bit phần lẻ) của pixel đầu một đoạn và bước khi sang cột kế tiếp
+     * tọa độ đầu đoạn được suy ra từ cột 0 bằng chính các bước dấu phẩy tĩnh,
+     * nên kết quả không phụ thuộc vào cách chia dòng thành các ô; toSampler đổi về tọa độ của Sampler
+     * @row: chỉ số dòng trên ảnh kết quả
+     * @col_begin: cột đầu đoạn
+     * @X, @Y, @dX, @dY: kết quả
+     */
+    void rowCoords(int row, int col_begin, int64_t& X, int64_t& Y, int64_t& dX, int64_t& dY) const {
+        // cộng sẵn bias() và nửa đơn vị của BITS bit để phép dịch trong toSampler là phép làm tròn
+        int64_t offset = ((int64_t)sampler.bias() << (ACC_BITS - BITS)) + ((int64_t)1 << (ACC_BITS - BITS - 1));
+        dX = fixed(inv_map(0, 1)), dY = fixed(inv_map(1, 1));
+        X = fixed(inv_map(0, 0) * row + inv_map(0, 2)) + col_begin * dX + offset;
+        Y = fixed(inv_map(1, 0) * row + inv_map(1, 2)) + col_begin * dY + offset;
+    }
+
+    // đổi tọa độ cộng dồn sang tọa độ dấu phẩy tĩnh BITS bit của Sampler
+    static int toSampler(int64_t v) {
+        return (int)(v >> (ACC_BITS - BITS));
+    }
+
+    // phần nguyên (pixel) của tọa độ cộng dồn
+    static int64_t whole(int64_t v) {
+        return v >> ACC_BITS;
+    }
+
+    // vị trí lẻ WBITS bit của tọa độ cộng dồn, đúng những bit Sampler dùng để chọn trọng số
+    static uchar subpixel(int64_t v) {
+        return (uchar)(v >> (ACC_BITS - Sampler::WBITS));
+    }
+
+    /**
+     * hàm tìm đoạn [lo, hi) trong n pixel mà phần nguyên của tọa độ cộng dồn (X + k * dX, Y + k * dY)
+     * nằm trong [before, rows - 1 - after] x [before, cols - 1 - after]
+     * ước lượng bằng số thực rồi hiệu chỉnh lại trên chính tọa độ dấu phẩy tĩnh, vì tập này là một đoạn liên tục
+     */
+    static void span(cv::Size src_size, int64_t X, int64_t Y, int64_t dX, int64_t dY, int n, int before, int after, int& lo, int& hi) {
+        const int64_t ACC_ONE = (int64_t)1 << ACC_BITS;
+
+        // dời gốc tọa độ về before để cận dưới là 0
+        X -= before * ACC_ONE, Y -= before * ACC_ONE;
+        int64_t rows = src_size.height - before - after, cols = src_size.width - before - after;
+        auto inside = [&](int k) {
+            int64_t x = X + k * dX, y = Y + k * dY;
+            return x >= 0 && x < rows * ACC_ONE && y >= 0 && y < cols * ACC_ONE;
+        };
+        if (rows <= 0 || cols <= 0) {
+            lo = hi = 0;
+            return;
+        }
+
+        // giao của 2 đoạn nghiệm theo x và theo y
+        double l = 0, h = n;
+        auto clip = [&](double v, double dv, double upper) {
+            if (dv == 0) {
+                if (v < 0 || v >= upper) {
+                    h = 0;
+                }
+                return;
+            }
+            double k1 = -v / dv, k2 = (upper - v) / dv;
+            l = std::max(l, std::min(k1, k2));
+            h = std::min(h, std::max(k1, k2));
+        };
+        clip((double)X, (double)dX, (double)rows * ACC_ONE);
+        clip((double)Y, (double)dY, (double)cols * ACC_ONE);
+
+        lo = std::max(0, (int)std::ceil(l));
+        hi = std::min(n, (int)std::ceil(h));
+        if (lo >= hi) {
+            lo = hi = 0;
+            return;
+        }
+
+        // hiệu chỉnh sai số làm tròn ở 2 đầu
+        while (lo < hi && !inside(lo)) {
+            ++lo;
+        }
+        while (lo > 0 && inside(lo - 1)) {
+            --lo;
+        }
+        while (hi > lo && !inside(hi - 1)) {
+            --hi;
+        }
+        while (hi < n && inside(hi)) {
+            ++hi;
+        }
+        if (lo >= hi) {
+            lo = hi = 0;
+        }
+    }
+
+private:
+    // phần thân của warpRow, cách nội suy là tham số khuôn mẫu để vòng lặp trong không phải rẽ nhánh
+    template <int INTERP>
+    void scan(Img src, cv::Mat& dst, int row, int col_begin, int col_end) const {
+        // bước khi sang cột kế tiếp và tọa độ nguồn của pixel đầu đoạn
+        int64_t X, Y, dX, dY;
+        rowCoords(row, col_begin, X, Y, dX, dY);
+
+        // đoạn [lo, hi) mà mọi điểm lân cận đều nằm trong ảnh
+        int before, after, lo, hi;
+        sampler.margins(before, after);
+        span(src.size(), X, Y, dX, dY, col_end - col_begin, before, after, lo, hi);
+
+        int cn = src.channels();
+        uchar* out = dst.ptr<uchar>(row) + col_begin * cn;
+        int k = 0;
+        for (; k < lo; ++k, X += dX, Y += dY) {
+            sampler.sampleChecked(src, toSampler(X), toSampler(Y), out + k * cn);
+        }
+        for (; k < hi; ++k, X += dX, Y += dY) {
+            sampler.sampleFast<INTERP>(src, toSampler(X), toSampler(Y), out + k * cn);
+        }
+        for (; k < col_end - col_begin; ++k, X += dX, Y += dY) {
+            sampler.sampleChecked(src, toSampler(X), toSampler(Y), out + k * cn);
+        }
+    }
+
+    // đổi số thực sang tọa độ cộng dồn ACC_BITS bit phần lẻ
+    static int64_t fixed(double v) {
+        return std::llround(std::ldexp(v, ACC_BITS));
+    }
+};
@@ -0,0 +1,189 @@
+#pragma once
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include "Sampler.h"
+#include "AffineWarper.h"
+#include "opencv2/core/core.hpp"
+
+typedef const cv::Mat& Img;
+
+// lớp áp dụng phép biến đổi phối cảnh (homography) lên ảnh theo từng dòng quét
+// quy ước tọa độ giống AffineWarper: x là chỉ số dòng, y là chỉ số cột
+// tọa độ thuần nhất (u, v, w) của ảnh nguồn là hàm tuyến tính theo cột nên chỉ cần cộng bước cố định như phép affine,
+// tọa độ thật là (u / w, v / w); thay vì chia cho mỗi pixel, nghịch đảo r = 1 / w chỉ được chia một lần ở đầu đoạn,
+// các pixel sau hiệu chỉnh r bằng các bước Newton r = r * (2 - w * r) vì w thay đổi rất ít giữa 2 pixel liền nhau
+// việc chia ô, lấy mẫu và xử lý biên dùng chung với AffineWarper
+class PerspectiveWarper {
+    static const int BITS = Sampler::BITS;
+    static const int ONE = Sampler::ONE;
+
+    // ma trận 3 x 3 ánh xạ tọa độ thuần nhất (x, y, 1) trên ảnh kết quả về tọa độ thuần nhất trên ảnh nguồn
+    cv::Matx33d inv_h;
+
+    // cách lấy mẫu và kiểu biên
+    Sampler sampler;
+public:
+    /**
+     * hàm khởi tạo từ ánh xạ ngược
+     * @inv_h: ma trận 3 x 3 ánh xạ tọa độ ảnh kết quả về tọa độ ảnh nguồn
+     * @sampler: cách lấy mẫu và kiểu biên
+     */
+    PerspectiveWarper(const cv::Matx33d& inv_h, const Sampler& sampler = Sampler()) : inv_h(inv_h), sampler(sampler) {}
+
+    /**
+     * phương thức tính ảnh kết quả vào ảnh cho trước
+     * pixel có w <= 0 (ảnh của nó nằm sau đường chân trời) không có điểm tương ứng trên ảnh nguồn và được tô 0
+     * @img: ảnh nguồn CV_8UC(n)
+     * @size: kích thước ảnh kết quả
+     * @dst: ảnh kết quả, được tạo lại nếu chưa đúng kích thước; nếu dùng chung vùng nhớ với @img thì ảnh nguồn được sao ra trước
+     */
+    void warp(Img img, cv::Size size, cv::Mat& dst) const {
+        // tọa độ nguồn đã được chặn trong clampCoord, chỉ cần ảnh nguồn không vượt giới hạn
+        AffineWarper::checkSource(img.size());
+        cv::Mat src = overlaps(img, dst) ? img.clone() : img;
+        dst.create(size, src.type());
+        AffineWarper::forEachTile(size, [&](const cv::Rect& tile) {
+            warpTile(src, dst, tile);
+        });
+    }
+
+    /**
+     * phương thức tính ảnh kết quả
+     * @src: ảnh nguồn CV_8UC(n)
+     * @size: kích thước ảnh kết quả
+     * @return: ảnh kết quả
+     */
+    cv::Mat warp(Img src, cv::Size size) const {
+        cv::Mat dst;
+        warp(src, size, dst);
+        return dst;
+    }
+
+    /**
+     * phương thức tính một ô hình chữ nhật của ảnh kết quả
+     * ô có vùng nguồn nằm hẳn ngoài ảnh với biên hằng thì được tô 0 luôn, không cần lấy mẫu
+     * @src: ảnh nguồn
+     * @dst: ảnh kết quả
+     * @tile: ô cần tính, theo quy ước của cv::Rect (x là cột, y là dòng)
+     */
+    void warpTile(Img src, cv::Mat& dst, const cv::Rect& tile) const {
+        cv::Rect area;
+        if (sampler.getBorder() == Sampler::CONSTANT && footprint(tile, area) && (area & cv::Rect(0, 0, src.cols, src.rows)).area() == 0) {
+            dst(tile).setTo(cv::Scalar::all(0));
+            return;
+        }
+        for (int i = tile.y; i < tile.y + tile.height; ++i) {
+            warpRow(src, dst, i, tile.x, tile.x + tile.width);
+        }
+    }
+
+    /**
+     * phương thức tính vùng ảnh nguồn mà một ô của ảnh kết quả cần đọc
+     * khi w > 0 trên cả 4 góc thì w > 0 trên cả ô, ảnh của ô là tứ giác lồi có đỉnh là ảnh 4 góc,
+     * nên vùng cần đọc là hình bao của 4 đỉnh đó, nới thêm các điểm lân cận của cách nội suy
+     * @tile: ô trên ảnh kết quả, theo quy ước của cv::Rect
+     * @area: vùng trên ảnh nguồn, theo quy ước của cv::Rect
+     * @return: false nếu ô chứa điểm có w <= 0, khi đó không có hình bao hữu hạn
+     */
+    bool footprint(const cv::Rect& tile, cv::Rect& area) const {
+        double xmin = DBL_MAX, ymin = DBL_MAX, xmax = -DBL_MAX, ymax = -DBL_MAX;
+        for (int i : {tile.y, tile.y + tile.height - 1}) {
+            for (int j : {tile.x, tile.x + tile.width - 1}) {
+                double w = inv_h(2, 0) * i + inv_h(2, 1) * j + inv_h(2, 2);
+                if (w <= 0) {
+                    return false;
+                }
+                double x = (inv_h(0, 0) * i + inv_h(0, 1) * j + inv_h(0, 2)) / w;
+                double y = (inv_h(1, 0) * i + inv_h(1, 1) * j + inv_h(1, 2)) / w;
+                xmin = std::min(xmin, x), xmax = std::max(xmax, x);
+                ymin = std::min(ymin, y), ymax = std::max(ymax, y);
+            }
+        }
+        int before, after;
+        sampler.margins(before, after);
+        int top = cvFloor(clampCoord(xmin)) - before - 1, left = cvFloor(clampCoord(ymin)) - before - 1;
+        int bottom = cvFloor(clampCoord(xmax)) + after + 1, right = cvFloor(clampCoord(ymax)) + after + 1;
+        area = cv::Rect(left, top, right - left + 1, bottom - top + 1);
+        return true;
+    }
+
+    /**
+     * phương thức tính một đoạn trên một dòng của ảnh kết quả
+     * @src: ảnh nguồn
+     * @dst: ảnh kết quả
+     * @row: chỉ số dòng trên ảnh kết quả
+     * @col_begin, @col_end: đoạn cột [col_begin, col_end) cần tính
+     */
+    void warpRow(Img src, cv::Mat& dst, int row, int col_begin, int col_end) const {
+        if (col_begin >= col_end) {
+            return;
+        }
+
+        switch (sampler.getInterp()) {
+            case Sampler::NEAREST:
+                scan<Sampler::NEAREST>(src, dst, row, col_begin, col_end);
+                break;
+            case Sampler::BILINEAR:
+                scan<Sampler::BILINEAR>(src, dst, row, col_begin, col_end);
+                break;
+            default:
+                scan<Sampler::BICUBIC>(src, dst, row, col_begin, col_end);
+                break;
+        }
+    }
+
+private:
+    // phần thân của warpRow, cách nội suy là tham số khuôn mẫu để vòng lặp trong không phải rẽ nhánh
+    template <int INTERP>
+    void scan(Img src, cv::Mat& dst, int row, int col_begin, int col_end) const {
+        // tọa độ thuần nhất của pixel đầu đoạn và bước khi sang cột kế tiếp
+        double u = inv_h(0, 0) * row + inv_h(0, 1) * col_begin + inv_h(0, 2);
+        double v = inv_h(1, 0) * row + inv_h(1, 1) * col_begin + inv_h(1, 2);
+        double w = inv_h(2, 0) * row + inv_h(2, 1) * col_begin + inv_h(2, 2);
+        double du = inv_h(0, 1), dv = inv_h(1, 1), dw = inv_h(2, 1);
+
+        // miền tọa độ dấu phẩy tĩnh mà mọi điểm lân cận đều nằm trong ảnh
+        int before, after;
+        sampler.margins(before, after);
+        int xlo = before * ONE, xhi = (src.rows - after) * ONE;
+        int ylo = before * ONE, yhi = (src.cols - after) * ONE;
+
+        int cn = src.channels();
+        uchar* out = dst.ptr<uchar>(row) + col_begin * cn;
+        double r = w > 0 ? 1 / w : 0;
+        for (int k = 0; k < col_end - col_begin; ++k, u += du, v += dv, w += dw) {
+            if (w <= 0) {
+                std::fill(out + k * cn, out + (k + 1) * cn, 0);
+                continue;
+            }
+
+            // hiệu chỉnh nghịch đảo bằng 2 bước Newton, sai số tương đối giảm từ e xuống e^4,
+            // chỉ chia lại khi sai số còn lớn (pixel đầu tiên có w > 0 sau đoạn w <= 0, hoặc w đổi nhanh gần đường chân trời)
+            double e = 1 - w * r;
+            if (e > 1e-3 || e < -1e-3) {
+                r = 1 / w;
+            }
+            else {
+                r += r * e;
+                r += r * (1 - w * r);
+            }
+
+            int X = cvRound(clampCoord(u * r) * ONE) + sampler.bias();
+            int Y = cvRound(clampCoord(v * r) * ONE) + sampler.bias();
+            if (X >= xlo && X < xhi && Y >= ylo && Y < yhi) {
+                sampler.sampleFast<INTERP>(src, X, Y, out + k * cn);
+            }
+            else {
+                sampler.sampleChecked(src, X, Y, out + k * cn);
+            }
+        }
+    }
+
+    // chặn tọa độ để đổi sang dấu phẩy tĩnh không bị tràn số, điểm bị chặn luôn nằm ngoài ảnh
+    // (chỉ xảy ra sát đường chân trời, nơi biên phản chiếu vốn không còn ý nghĩa)
+    static double clampCoord(double v) {
+        const double LIMIT = 30000;
+        return v < -LIMIT ? -LIMIT : v > LIMIT ? LIMIT : v;
+    }
+};
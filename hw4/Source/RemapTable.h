@@ -0,0 +1,205 @@
+#pragma once
+#include <map>
+#include <array>
+#include <tuple>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <climits>
+#include <stdexcept>
+#include "Sampler.h"
+#include "AffineWarper.h"
+#include "opencv2/core/core.hpp"
+#include "opencv2/core/utility.hpp" // cần hàm cv::parallel_for_
+
+// lớp bảng ánh xạ tính sẵn cho một phép biến đổi affine cố định
+// khi cùng một phép biến đổi được áp dụng lên nhiều ảnh cùng kích thước (các khung hình của một chuỗi),
+// tọa độ nguồn của mỗi pixel kết quả chỉ cần tính một lần; mỗi lần áp dụng sau đó chỉ đọc tuần tự bảng
+// và gom pixel nguồn tương ứng
+// mỗi pixel kết quả lưu 6 byte: phần nguyên tọa độ (x, y) dạng int16 và vị trí lẻ (a, b) dạng uint8,
+// đúng những bit mà Sampler dùng, nên kết quả giống hệt AffineWarper với cùng ánh xạ và sampler
+// tọa độ được tính bằng đúng phép cộng dồn 64 bit của AffineWarper rồi mới tách phần nguyên và vị trí lẻ;
+// riêng tọa độ nằm ngoài [-32768, 32767] bị chặn lại; với biên hằng và lặp pixel rìa điều này không đổi kết quả,
+// với biên phản chiếu chỉ khác ở các pixel cách ảnh nguồn hơn 32767 pixel
+class RemapTable {
+    static const int BITS = Sampler::BITS;
+    static const int WBITS = Sampler::WBITS;
+
+    // kích thước ảnh nguồn và ảnh kết quả
+    cv::Size src_size, dst_size;
+
+    // cách lấy mẫu và kiểu biên
+    Sampler sampler;
+
+    // phần nguyên tọa độ (x, y) và vị trí lẻ (a, b) của từng pixel kết quả, theo thứ tự dòng
+    std::vector<short> xy;
+    std::vector<uchar> ab;
+
+    // đoạn [lo, hi) trên mỗi dòng mà mọi điểm lân cận đều nằm trong ảnh nguồn
+    std::vector<cv::Vec2i> spans;
+public:
+    /**
+     * hàm khởi tạo: tính tọa độ nguồn của mọi pixel kết quả bằng đúng các bước dấu phẩy tĩnh của AffineWarper
+     * @inv_map: ma trận 2 x 3 ánh xạ tọa độ ảnh kết quả về tọa độ ảnh nguồn
+     * @src_size: kích thước ảnh nguồn
+     * @dst_size: kích thước ảnh kết quả
+     * @sampler: cách lấy mẫu và kiểu biên
+     */
+    RemapTable(const cv::Matx23d& inv_map, cv::Size src_size, cv::Size dst_size, const Sampler& sampler = Sampler())
+        : src_size(src_size), dst_size(dst_size), sampler(sampler) {
+        if (src_size.width > SHRT_MAX || src_size.height > SHRT_MAX) {
+            throw std::runtime_error("Anh nguon qua lon cho bang anh xa");
+        }
+
+        size_t area = (size_t)dst_size.area();
+        xy.resize(2 * area), ab.resize(2 * area), spans.resize(dst_size.height);
+
+        AffineWarper warper(inv_map, sampler);
+        int before, after;
+        sampler.margins(before, after);
+        cv::parallel_for_(cv::Range(0, dst_size.height), [&](const cv::Range& range) {
+            for (int i = range.start; i < range.end; ++i) {
+                int64_t X, Y, dX, dY;
+                int lo, hi;
+                warper.rowCoords(i, 0, X, Y, dX, dY);
+                AffineWarper::span(src_size, X, Y, dX, dY, dst_size.width, before, after, lo, hi);
+                spans[i] = cv::Vec2i(lo, hi);
+
+                short* pxy = &xy[2 * (size_t)i * dst_size.width];
+                uchar* pab = &ab[2 * (size_t)i * dst_size.width];
+                for (int k = 0; k < dst_size.width; ++k, X += dX, Y += dY) {
+                    pxy[2 * k] = clamp(AffineWarper::whole(X));
+                    pxy[2 * k + 1] = clamp(AffineWarper::whole(Y));
+                    pab[2 * k] = AffineWarper::subpixel(X);
+                    pab[2 * k + 1] = AffineWarper::subpixel(Y);
+                }
+            }
+        });
+    }
+
+    cv::Size getSrcSize() const {
+        return src_size;
+    }
+
+    cv::Size getDstSize() const {
+        return dst_size;
+    }
+
+    /**
+     * phương thức áp dụng bảng lên một ảnh, ghi vào ảnh cho trước
+     * @img: ảnh nguồn CV_8UC(n), cùng kích thước với src_size lúc khởi tạo
+     * @dst: ảnh kết quả, được tạo lại nếu chưa đúng kích thước; nếu dùng chung vùng nhớ với @img thì ảnh nguồn được sao ra trước
+     */
+    void apply(Img img, cv::Mat& dst) const {
+        if (img.size() != src_size) {
+            throw std::runtime_error("Kich thuoc anh khong khop voi bang anh xa");
+        }
+
+        cv::Mat src = overlaps(img, dst) ? img.clone() : img;
+        dst.create(dst_size, src.type());
+        cv::parallel_for_(cv::Range(0, dst_size.height), [&](const cv::Range& range) {
+            for (int i = range.start; i < range.end; ++i) {
+                switch (sampler.getInterp()) {
+                    case Sampler::NEAREST:
+                        gather<Sampler::NEAREST>(src, dst, i);
+                        break;
+                    case Sampler::BILINEAR:
+                        gather<Sampler::BILINEAR>(src, dst, i);
+                        break;
+                    default:
+                        gather<Sampler::BICUBIC>(src, dst, i);
+                        break;
+                }
+            }
+        });
+    }
+
+    /**
+     * phương thức áp dụng bảng lên một ảnh
+     * @src: ảnh nguồn CV_8UC(n), cùng kích thước với src_size lúc khởi tạo
+     * @return: ảnh kết quả
+     */
+    cv::Mat apply(Img src) const {
+        cv::Mat dst;
+        apply(src, dst);
+        return dst;
+    }
+
+private:
+    // tính một dòng ảnh kết quả, cách nội suy là tham số khuôn mẫu để vòng lặp trong không phải rẽ nhánh
+    template <int INTERP>
+    void gather(Img src, cv::Mat& dst, int row) const {
+        const short* pxy = &xy[2 * (size_t)row * dst_size.width];
+        const uchar* pab = &ab[2 * (size_t)row * dst_size.width];
+        int cn = src.channels();
+        uchar* out = dst.ptr<uchar>(row);
+
+        // dựng lại tọa độ dấu phẩy tĩnh, các bit thấp hơn vị trí lẻ không được Sampler dùng đến
+        auto X = [&](int k) { return pxy[2 * k] * Sampler::ONE + (pab[2 * k] << (BITS - WBITS)); };
+        auto Y = [&](int k) { return pxy[2 * k + 1] * Sampler::ONE + (pab[2 * k + 1] << (BITS - WBITS)); };
+
+        int lo = spans[row][0], hi = spans[row][1], k = 0;
+        for (; k < lo; ++k) {
+            sampler.sampleChecked(src, X(k), Y(k), out + k * cn);
+        }
+        for (; k < hi; ++k) {
+            sampler.sampleFast<INTERP>(src, X(k), Y(k), out + k * cn);
+        }
+        for (; k < dst_size.width; ++k) {
+            sampler.sampleChecked(src, X(k), Y(k), out + k * cn);
+        }
+    }
+
+    // chặn phần nguyên tọa độ vào miền của int16
+    static short clamp(int64_t v) {
+        return (short)(v < SHRT_MIN ? SHRT_MIN : v > SHRT_MAX ? SHRT_MAX : v);
+    }
+};
+
+// bộ nhớ đệm các bảng ánh xạ, khóa là (ánh xạ, kích thước ảnh nguồn, kích thước ảnh kết quả, cách lấy mẫu)
+// dùng chung được giữa nhiều luồng; khi đầy thì xóa hết rồi tính lại vì thường chỉ có vài phép biến đổi lặp lại
+class RemapCache {
+    typedef std::tuple<std::array<double, 6>, int, int, int, int, int, int> Key;
+
+    std::map<Key, std::shared_ptr<const RemapTable>> tables;
+    size_t capacity;
+    std::mutex mtx;
+public:
+    /**
+     * hàm khởi tạo
+     * @capacity: số bảng tối đa được giữ lại
+     */
+    RemapCache(size_t capacity = 8) : capacity(capacity) {}
+
+    /**
+     * phương thức lấy bảng ứng với một phép biến đổi, tính bảng mới nếu chưa có
+     * @inv_map: ma trận 2 x 3 ánh xạ tọa độ ảnh kết quả về tọa độ ảnh nguồn
+     * @src_size: kích thước ảnh nguồn
+     * @dst_size: kích thước ảnh kết quả
+     * @sampler: cách lấy mẫu và kiểu biên
+     * @return: bảng ánh xạ
+     */
+    std::shared_ptr<const RemapTable> get(const cv::Matx23d& inv_map, cv::Size src_size, cv::Size dst_size, const Sampler& sampler = Sampler()) {
+        std::array<double, 6> m;
+        std::copy(inv_map.val, inv_map.val + 6, m.begin());
+        Key key(m, src_size.width, src_size.height, dst_size.width, dst_size.height, sampler.getInterp(), sampler.getBorder());
+
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = tables.find(key);
+        if (it != tables.end()) {
+            return it->second;
+        }
+        if (tables.size() >= capacity) {
+            tables.clear();
+        }
+        auto table = std::make_shared<const RemapTable>(inv_map, src_size, dst_size, sampler);
+        tables[key] = table;
+        return table;
+    }
+
+    // số bảng đang được giữ
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return tables.size();
+    }
+};
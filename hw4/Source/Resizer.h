@@ -0,0 +1,252 @@
+#pragma once
+#include <cmath>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+#include "opencv2/core/core.hpp"
+#include "opencv2/core/utility.hpp" // cần hàm cv::parallel_for_
+
+#define RESIZE_MD_AREA    "area"    // trung bình diện tích: mỗi pixel mới là trung bình các pixel cũ mà nó phủ lên
+#define RESIZE_MD_LANCZOS "lanczos" // nhân Lanczos 3 thùy, được giãn theo tỉ lệ thu nhỏ để chống răng cưa
+
+typedef const cv::Mat& Img;
+
+// lớp thay đổi kích thước ảnh CV_8UC(n) bằng bộ lọc tách được
+// mỗi trục có một bảng hệ số tính trước: với mỗi chỉ số trên ảnh mới, chỉ số pixel nguồn đầu tiên và taps trọng số
+// nguyên có tổng 2^WBITS; pixel ngoài ảnh được gộp trọng số vào pixel rìa ngay trong bảng nên vòng lặp không kiểm tra biên
+// ảnh kết quả được chia thành các dải dòng chạy song song; trong mỗi dải, dòng nguồn được lọc theo chiều ngang vào
+// bộ đệm vòng chỉ chứa cy.taps dòng ngay khi cần, rồi các dòng kết quả được lọc theo chiều dọc trên bộ đệm đó,
+// nên bộ nhớ tạm chỉ cỡ taps x chiều rộng mới mỗi dải thay vì cả ảnh đã lọc ngang
+// khi thu nhỏ theo diện tích đúng 2^k lần trên cả 2 trục, ảnh được chia đôi k lần bằng trung bình khối 2 x 2
+class Resizer {
+    // số bit của trọng số, và số bit phần lẻ giữ lại sau lượt ngang
+    static const int WBITS = 12;
+    static const int HBITS = 8;
+
+    // số dòng kết quả tối thiểu của một dải chạy song song, mỗi dải phải lọc ngang lại tối đa cy.taps dòng nguồn ở đầu dải
+    static const int BAND_ROWS = 16;
+
+    enum { AREA, LANCZOS } kernel;
+
+    // bảng hệ số của một trục
+    struct Coeffs {
+        int taps;
+        std::vector<int> start;
+        std::vector<int> weight;
+    };
+public:
+    /**
+     * hàm khởi tạo
+     * @kernel: RESIZE_MD_AREA hoặc RESIZE_MD_LANCZOS
+     */
+    Resizer(const std::string& kernel = RESIZE_MD_AREA) {
+        if (kernel == RESIZE_MD_AREA) {
+            this->kernel = AREA;
+        }
+        else if (kernel == RESIZE_MD_LANCZOS) {
+            this->kernel = LANCZOS;
+        }
+        else {
+            throw std::runtime_error("Khong ho tro bo loc " + kernel);
+        }
+    }
+
+    /**
+     * phương thức thay đổi kích thước ảnh
+     * @src: ảnh nguồn CV_8UC(n)
+     * @size: kích thước ảnh kết quả
+     * @return: ảnh kết quả
+     */
+    cv::Mat apply(Img src, cv::Size size) const {
+        if (size.width <= 0 || size.height <= 0) {
+            throw std::runtime_error("Kich thuoc anh moi khong hop le");
+        }
+
+        int levels;
+        if (kernel == AREA && isPyramid(src.size(), size, levels)) {
+            cv::Mat res = src;
+            for (int k = 0; k < levels; ++k) {
+                res = halve(res);
+            }
+            return res;
+        }
+
+        Coeffs cx = coeffs(src.cols, size.width), cy = coeffs(src.rows, size.height);
+        int cn = src.channels(), row_len = size.width * cn;
+
+        // các dải dòng kết quả chạy song song, mỗi dải chỉ lọc ngang các dòng nguồn nó cần
+        int bands = std::max(1, std::min(size.height / BAND_ROWS, cv::getNumThreads() * 4));
+        cv::Mat dst(size, src.type());
+        cv::parallel_for_(cv::Range(0, bands), [&](const cv::Range& range) {
+            // bộ đệm vòng cy.taps dòng đã lọc ngang (giá trị nhân 2^HBITS), dòng nguồn k nằm ở ô k % cy.taps;
+            // cy.start không giảm nên các dòng nguồn trước cy.start[i] không còn được dùng và bị ghi đè dần
+            std::vector<int> ring((size_t)cy.taps * row_len);
+            std::vector<int> acc(row_len);
+            for (int b = range.start; b < range.end; ++b) {
+                int i0 = (int)((long long)size.height * b / bands), i1 = (int)((long long)size.height * (b + 1) / bands);
+                int next = 0; // dòng nguồn kế tiếp chưa lọc ngang
+                for (int i = i0; i < i1; ++i) {
+                    int first = cy.start[i], last = first + cy.taps;
+                    for (int k = std::max(next, first); k < last; ++k) {
+                        filterRow(src.ptr<uchar>(k), cx, cn, size.width, &ring[(size_t)(k % cy.taps) * row_len]);
+                    }
+                    next = std::max(next, last);
+
+                    // lượt dọc: cộng dồn cả dòng một lúc để truy cập bộ nhớ tuần tự
+                    std::fill(acc.begin(), acc.end(), 1 << (WBITS + HBITS - 1));
+                    const int* w = &cy.weight[(size_t)i * cy.taps];
+                    for (int t = 0; t < cy.taps; ++t) {
+                        const int* q = &ring[(size_t)((first + t) % cy.taps) * row_len];
+                        for (int j = 0; j < row_len; ++j) {
+                            acc[j] += q[j] * w[t];
+                        }
+                    }
+                    uchar* out = dst.ptr<uchar>(i);
+                    for (int j = 0; j < row_len; ++j) {
+                        out[j] = cv::saturate_cast<uchar>(acc[j] >> (WBITS + HBITS));
+                    }
+                }
+            }
+        });
+        return dst;
+    }
+
+    /**
+     * hàm chia đôi kích thước ảnh, mỗi pixel mới là trung bình khối 2 x 2 pixel cũ
+     * @src: ảnh nguồn CV_8UC(n) có số dòng và số cột chẵn
+     * @return: ảnh kết quả
+     */
+    static cv::Mat halve(Img src) {
+        cv::Mat dst(src.rows / 2, src.cols / 2, src.type());
+        int cn = src.channels();
+        cv::parallel_for_(cv::Range(0, dst.rows), [&](const cv::Range& range) {
+            for (int i = range.start; i < range.end; ++i) {
+                const uchar* p0 = src.ptr<uchar>(2 * i);
+                const uchar* p1 = src.ptr<uchar>(2 * i + 1);
+                uchar* q = dst.ptr<uchar>(i);
+                for (int j = 0; j < dst.cols; ++j, p0 += 2 * cn, p1 += 2 * cn, q += cn) {
+                    for (int c = 0; c < cn; ++c) {
+                        q[c] = (uchar)((p0[c] + p0[c + cn] + p1[c] + p1[c + cn] + 2) >> 2);
+                    }
+                }
+            }
+        });
+        return dst;
+    }
+
+private:
+    /**
+     * hàm lọc ngang một dòng nguồn
+     * @p: dòng nguồn
+     * @cx: bảng hệ số trục ngang
+     * @cn: số kênh
+     * @width: số pixel của dòng kết quả
+     * @q: dòng kết quả width * cn phần tử, giá trị nhân 2^HBITS
+     */
+    static void filterRow(const uchar* p, const Coeffs& cx, int cn, int width, int* q) {
+        for (int j = 0; j < width; ++j) {
+            const uchar* s = p + cx.start[j] * cn;
+            const int* w = &cx.weight[(size_t)j * cx.taps];
+            for (int c = 0; c < cn; ++c) {
+                int sum = 0;
+                for (int t = 0; t < cx.taps; ++t) {
+                    sum += s[t * cn + c] * w[t];
+                }
+                q[j * cn + c] = (sum + (1 << (WBITS - HBITS - 1))) >> (WBITS - HBITS);
+            }
+        }
+    }
+
+    // kiểm tra @src có đúng bằng @dst nhân 2^levels trên cả 2 trục (levels >= 1)
+    static bool isPyramid(cv::Size src, cv::Size dst, int& levels) {
+        levels = 0;
+        while (dst.width * 2 <= src.width && dst.height * 2 <= src.height) {
+            if (src.width % 2 || src.height % 2) {
+                return false;
+            }
+            src = cv::Size(src.width / 2, src.height / 2);
+            ++levels;
+        }
+        return levels > 0 && src == dst;
+    }
+
+    // nhân Lanczos 3 thùy
+    static double lanczos(double x) {
+        const double PI = 3.14159265359;
+        x = std::abs(x);
+        if (x < 1e-8) {
+            return 1;
+        }
+        if (x >= 3) {
+            return 0;
+        }
+        return 3 * std::sin(PI * x) * std::sin(PI * x / 3) / (PI * PI * x * x);
+    }
+
+    /**
+     * phương thức tính bảng hệ số của một trục
+     * @src_len: số pixel trên trục của ảnh nguồn
+     * @dst_len: số pixel trên trục của ảnh kết quả
+     * @return: bảng hệ số, mọi chỉ số pixel trong bảng nằm trong [0, src_len)
+     */
+    Coeffs coeffs(int src_len, int dst_len) const {
+        double scale = (double)src_len / dst_len;
+
+        // trọng số thực và chỉ số nguồn đầu tiên (có thể ngoài ảnh) của mỗi pixel mới
+        std::vector<int> first(dst_len);
+        std::vector<std::vector<double>> raw(dst_len);
+        size_t max_taps = 1;
+        for (int i = 0; i < dst_len; ++i) {
+            if (kernel == AREA) {
+                // khoảng [a, b) trên trục nguồn mà pixel i phủ lên, trọng số là độ dài phần giao với từng pixel
+                double a = i * scale, b = (i + 1) * scale;
+                first[i] = (int)std::floor(a);
+                for (int k = first[i]; k < b; ++k) {
+                    raw[i].push_back(std::min(b, k + 1.0) - std::max(a, (double)k));
+                }
+            }
+            else {
+                // khi thu nhỏ, nhân được giãn ra theo tỉ lệ để lọc bỏ tần số cao trước khi lấy mẫu
+                double support = std::max(scale, 1.0);
+                double center = (i + 0.5) * scale - 0.5;
+                first[i] = (int)std::floor(center - 3 * support) + 1;
+                for (int k = first[i]; k < center + 3 * support; ++k) {
+                    raw[i].push_back(lanczos((k - center) / support));
+                }
+            }
+            max_taps = std::max(max_taps, raw[i].size());
+        }
+
+        Coeffs res;
+        res.taps = std::min((int)max_taps, src_len);
+        res.start.resize(dst_len);
+        res.weight.assign((size_t)dst_len * res.taps, 0);
+        std::vector<double> w(res.taps);
+        for (int i = 0; i < dst_len; ++i) {
+            // dời cửa sổ vào trong ảnh, trọng số của pixel ngoài ảnh dồn vào pixel rìa
+            int s = std::max(0, std::min(first[i], src_len - res.taps));
+            std::fill(w.begin(), w.end(), 0.0);
+            double total = 0;
+            for (size_t t = 0; t < raw[i].size(); ++t) {
+                int idx = std::max(0, std::min(first[i] + (int)t, src_len - 1));
+                w[idx - s] += raw[i][t];
+                total += raw[i][t];
+            }
+
+            // làm tròn rồi dồn sai số vào trọng số lớn nhất để tổng luôn đúng bằng 2^WBITS
+            int* wi = &res.weight[(size_t)i * res.taps];
+            int sum = 0, big = 0;
+            for (int t = 0; t < res.taps; ++t) {
+                wi[t] = cvRound(w[t] / total * (1 << WBITS));
+                sum += wi[t];
+                if (wi[t] > wi[big]) {
+                    big = t;
+                }
+            }
+            wi[big] += (1 << WBITS) - sum;
+            res.start[i] = s;
+        }
+        return res;
+    }
+};
@@ -0,0 +1,273 @@
+#pragma once
+#include <cmath>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include "opencv2/core/core.hpp"
+
+#define INTER_MD_NEAREST   "nearest"   // lấy pixel gần nhất
+#define INTER_MD_BILINEAR  "bilinear"  // nội suy song tuyến tính từ 2 x 2 pixel
+#define INTER_MD_BICUBIC   "bicubic"   // nội suy bậc 3 từ 4 x 4 pixel
+
+#define BORDER_MD_CONSTANT  "constant"  // pixel ngoài ảnh có giá trị 0
+#define BORDER_MD_REPLICATE "replicate" // lặp lại pixel ở rìa: aaa|abcd|ddd
+#define BORDER_MD_REFLECT   "reflect"   // phản chiếu không lặp pixel rìa: dcb|abcd|cba
+
+typedef const cv::Mat& Img;
+
+// lớp lấy mẫu ảnh CV_8UC(n) tại tọa độ không nguyên
+// tọa độ ở dạng số nguyên dấu phẩy tĩnh BITS bit phần lẻ, x là chỉ số dòng, y là chỉ số cột
+// mỗi cách nội suy có 2 phiên bản:
+// - sampleFast: không kiểm tra biên, chỉ được gọi khi mọi điểm lân cận nằm trong ảnh (xem margins)
+// - sampleChecked: đưa điểm lân cận ngoài ảnh về trong ảnh theo kiểu biên đã chọn
+// phần nguyên của tọa độ luôn lấy bằng floor (dịch bit số học) nên trọng số nội suy luôn nằm trong [0, 1)
+class Sampler {
+public:
+    enum Interp { NEAREST, BILINEAR, BICUBIC };
+    enum Border { CONSTANT, REPLICATE, REFLECT };
+
+    // số bit phần lẻ của tọa độ
+    static const int BITS = 16;
+    static const int ONE = 1 << BITS;
+
+    // số bit của vị trí lẻ dùng tra trọng số, và số bit của trọng số
+    static const int WBITS = 8;
+    static const int WSIZE = 1 << WBITS;
+    static const int CBITS = 11;
+
+private:
+    Interp interp;
+    Border border;
+
+    // trọng số bậc 3 (Keys, a = -0.75 như opencv) của 4 điểm lân cận ứng với mỗi vị trí lẻ, nhân 2^CBITS
+    int cubic[WSIZE][4];
+public:
+    /**
+     * hàm khởi tạo
+     * @interp: cách nội suy
+     * @border: kiểu biên
+     */
+    Sampler(Interp interp = BILINEAR, Border border = CONSTANT) : interp(interp), border(border) {
+        init();
+    }
+
+    /**
+     * hàm khởi tạo từ mã chuỗi, dùng cho tham số dòng lệnh
+     * @interp: INTER_MD_NEAREST, INTER_MD_BILINEAR hoặc INTER_MD_BICUBIC
+     * @border: BORDER_MD_CONSTANT, BORDER_MD_REPLICATE hoặc BORDER_MD_REFLECT
+     */
+    Sampler(const std::string& interp, const std::string& border) {
+        if (interp == INTER_MD_NEAREST) {
+            this->interp = NEAREST;
+        }
+        else if (interp == INTER_MD_BILINEAR) {
+            this->interp = BILINEAR;
+        }
+        else if (interp == INTER_MD_BICUBIC) {
+            this->interp = BICUBIC;
+        }
+        else {
+            throw std::runtime_error("Khong ho tro cach noi suy " + interp);
+        }
+
+        if (border == BORDER_MD_CONSTANT) {
+            this->border = CONSTANT;
+        }
+        else if (border == BORDER_MD_REPLICATE) {
+            this->border = REPLICATE;
+        }
+        else if (border == BORDER_MD_REFLECT) {
+            this->border = REFLECT;
+        }
+        else {
+            throw std::runtime_error("Khong ho tro kieu bien " + border);
+        }
+        init();
+    }
+
+    Interp getInterp() const {
+        return interp;
+    }
+
+    Border getBorder() const {
+        return border;
+    }
+
+    /**
+     * phương thức lấy số pixel lân cận cần có ở phía trước và phía sau phần nguyên của tọa độ
+     * sampleFast hợp lệ khi floor(x) - @before >= 0 và floor(x) + @after <= rows - 1, tương tự với y
+     * @before, @after: kết quả
+     */
+    void margins(int& before, int& after) const {
+        before = interp == BICUBIC ? 1 : 0;
+        after = interp == NEAREST ? 0 : interp == BILINEAR ? 1 : 2;
+    }
+
+    /**
+     * phương thức lấy độ lệch cần cộng vào tọa độ trước khi lấy mẫu
+     * lấy pixel gần nhất bằng floor(x + 0.5) nên cộng sẵn nửa pixel, các cách còn lại không cần
+     * @return: độ lệch dạng dấu phẩy tĩnh
+     */
+    int bias() const {
+        return interp == NEAREST ? ONE / 2 : 0;
+    }
+
+    /**
+     * phương thức lấy mẫu không kiểm tra biên
+     * @src: ảnh nguồn
+     * @X, @Y: tọa độ dấu phẩy tĩnh đã cộng bias()
+     * @out: pixel kết quả, src.channels() byte
+     */
+    template <int INTERP>
+    void sampleFast(Img src, int X, int Y, uchar* out) const {
+        int cn = src.channels();
+        int x = X >> BITS, y = Y >> BITS;
+        if (INTERP == NEAREST) {
+            const uchar* p = src.ptr<uchar>(x) + y * cn;
+            for (int c = 0; c < cn; ++c) {
+                out[c] = p[c];
+            }
+            return;
+        }
+
+        int a = (X >> (BITS - WBITS)) & (WSIZE - 1);
+        int b = (Y >> (BITS - WBITS)) & (WSIZE - 1);
+        if (INTERP == BILINEAR) {
+            // nạp cặp dòng x, x + 1 một lần, mỗi dòng 2 pixel liền nhau
+            const uchar* p0 = src.ptr<uchar>(x) + y * cn;
+            const uchar* p1 = p0 + src.step;
+            int w00 = (WSIZE - a) * (WSIZE - b), w01 = (WSIZE - a) * b, w10 = a * (WSIZE - b), w11 = a * b;
+            if (cn == 3) {
+                // trường hợp phổ biến CV_8UC3 được trải vòng lặp kênh để trình biên dịch dùng SIMD trên 3 kênh
+                out[0] = (p0[0] * w00 + p0[3] * w01 + p1[0] * w10 + p1[3] * w11 + (1 << (2 * WBITS - 1))) >> (2 * WBITS);
+                out[1] = (p0[1] * w00 + p0[4] * w01 + p1[1] * w10 + p1[4] * w11 + (1 << (2 * WBITS - 1))) >> (2 * WBITS);
+                out[2] = (p0[2] * w00 + p0[5] * w01 + p1[2] * w10 + p1[5] * w11 + (1 << (2 * WBITS - 1))) >> (2 * WBITS);
+                return;
+            }
+            for (int c = 0; c < cn; ++c) {
+                out[c] = (p0[c] * w00 + p0[c + cn] * w01 + p1[c] * w10 + p1[c + cn] * w11 + (1 << (2 * WBITS - 1))) >> (2 * WBITS);
+            }
+            return;
+        }
+
+        // bậc 3: nội suy theo cột trên 4 dòng rồi nội suy theo dòng
+        const int* wx = cubic[a];
+        const int* wy = cubic[b];
+        for (int c = 0; c < cn; ++c) {
+            int sum = 0;
+            for (int i = 0; i < 4; ++i) {
+                const uchar* p = src.ptr<uchar>(x - 1 + i) + (y - 1) * cn + c;
+                int row = p[0] * wy[0] + p[cn] * wy[1] + p[2 * cn] * wy[2] + p[3 * cn] * wy[3];
+                sum += row * wx[i];
+            }
+            out[c] = cv::saturate_cast<uchar>((sum + (1 << (2 * CBITS - 1))) >> (2 * CBITS));
+        }
+    }
+
+    /**
+     * phương thức lấy mẫu có xử lý biên, dùng được với mọi tọa độ
+     * @src: ảnh nguồn
+     * @X, @Y: tọa độ dấu phẩy tĩnh đã cộng bias()
+     * @out: pixel kết quả, src.channels() byte
+     */
+    void sampleChecked(Img src, int X, int Y, uchar* out) const {
+        int cn = src.channels();
+        int x = X >> BITS, y = Y >> BITS;
+        int a = (X >> (BITS - WBITS)) & (WSIZE - 1);
+        int b = (Y >> (BITS - WBITS)) & (WSIZE - 1);
+
+        // trọng số và số điểm lân cận theo mỗi chiều
+        int n, shift, start;
+        int wx[4], wy[4];
+        if (interp == NEAREST) {
+            n = 1, shift = 0, start = 0;
+            wx[0] = wy[0] = 1;
+        }
+        else if (interp == BILINEAR) {
+            n = 2, shift = WBITS, start = 0;
+            wx[0] = WSIZE - a, wx[1] = a;
+            wy[0] = WSIZE - b, wy[1] = b;
+        }
+        else {
+            n = 4, shift = CBITS, start = -1;
+            std::copy(cubic[a], cubic[a] + 4, wx);
+            std::copy(cubic[b], cubic[b] + 4, wy);
+        }
+
+        // chỉ số dòng/cột sau khi xử lý biên, -1 nghĩa là pixel hằng 0
+        int xs[4], ys[4];
+        for (int i = 0; i < n; ++i) {
+            xs[i] = borderIndex(x + start + i, src.rows);
+            ys[i] = borderIndex(y + start + i, src.cols);
+        }
+
+        for (int c = 0; c < cn; ++c) {
+            long long sum = 0;
+            for (int i = 0; i < n; ++i) {
+                if (xs[i] < 0) {
+                    continue;
+                }
+                const uchar* p = src.ptr<uchar>(xs[i]);
+                long long row = 0;
+                for (int j = 0; j < n; ++j) {
+                    if (ys[j] >= 0) {
+                        row += p[ys[j] * cn + c] * wy[j];
+                    }
+                }
+                sum += row * wx[i];
+            }
+            out[c] = cv::saturate_cast<uchar>(shift == 0 ? sum : (sum + (1LL << (2 * shift - 1))) >> (2 * shift));
+        }
+    }
+
+    /**
+     * phương thức đưa chỉ số ngoài ảnh về trong ảnh theo kiểu biên
+     * @p: chỉ số
+     * @len: số dòng hoặc số cột của ảnh
+     * @return: chỉ số trong [0, len), hoặc -1 nếu biên hằng và @p nằm ngoài ảnh
+     */
+    int borderIndex(int p, int len) const {
+        if (p >= 0 && p < len) {
+            return p;
+        }
+        if (border == CONSTANT) {
+            return -1;
+        }
+        if (border == REPLICATE || len == 1) {
+            return std::max(0, std::min(p, len - 1));
+        }
+
+        // phản chiếu có chu kỳ 2 * (len - 1)
+        int period = 2 * (len - 1);
+        p %= period;
+        if (p < 0) {
+            p += period;
+        }
+        return p < len ? p : period - p;
+    }
+
+private:
+    // tính bảng trọng số bậc 3
+    void init() {
+        const double A = -0.75;
+        for (int k = 0; k < WSIZE; ++k) {
+            double t = (double)k / WSIZE;
+            double w[4];
+            w[0] = ((A * (t + 1) - 5 * A) * (t + 1) + 8 * A) * (t + 1) - 4 * A;
+            w[1] = ((A + 2) * t - (A + 3)) * t * t + 1;
+            w[2] = ((A + 2) * (1 - t) - (A + 3)) * (1 - t) * (1 - t) + 1;
+            w[3] = 1 - w[0] - w[1] - w[2];
+
+            // làm tròn rồi dồn sai số vào trọng số lớn nhất để tổng luôn đúng bằng 2^CBITS
+            int sum = 0, big = 1;
+            for (int i = 0; i < 4; ++i) {
+                cubic[k][i] = cvRound(w[i] * (1 << CBITS));
+                sum += cubic[k][i];
+                if (cubic[k][i] > cubic[k][big]) {
+                    big = i;
+                }
+            }
+            cubic[k][big] += (1 << CBITS) - sum;
+        }
+    }
+};
@@ -0,0 +1,170 @@
+#pragma once
+#include <cmath>
+#include <string>
+#include <cstring>
+#include <stdexcept>
+#include "opencv2/core/core.hpp"
+#include "opencv2/core/utility.hpp" // cần hàm cv::parallel_for_
+
+#define FLIP_MD_X  "x"  // lật theo trục x: đảo thứ tự các dòng
+#define FLIP_MD_Y  "y"  // lật theo trục y: đảo thứ tự các cột
+#define FLIP_MD_XY "xy" // lật cả 2 trục, bằng xoay 180 độ
+
+typedef const cv::Mat& Img;
+
+// lớp hoán vị pixel chính xác: lật, chuyển vị và xoay bội của 90 độ
+// các phép này không nội suy nên kết quả không mất mát, tốc độ chỉ bị giới hạn bởi băng thông bộ nhớ:
+// - lật không đổi dòng thành cột nên được chép theo từng dòng, đọc và ghi đều tuần tự
+// - chuyển vị (và xoay 90, 270 độ = chuyển vị kèm lật) đọc theo dòng nhưng ghi theo cột, nên được chia thành
+//   các khối BLOCK x BLOCK pixel để cả khối nguồn và khối đích cùng nằm trong cache; phép lật được gộp vào
+//   chỉ số đích nên mỗi pixel chỉ được chép đúng một lần
+class Transposer {
+    // cạnh khối chuyển vị, 16 x 16 pixel CV_8UC3 là 768 byte mỗi khối
+    static const int BLOCK = 16;
+public:
+    /**
+     * hàm kiểm tra góc xoay có phải bội của 90 độ
+     * @phi: góc xoay (radian)
+     * @quarters: số lần xoay 90 độ tương ứng, trong [0, 4)
+     * @return: true nếu @phi cách một bội của 90 độ không quá 1e-9 radian
+     */
+    static bool isRightAngle(double phi, int& quarters) {
+        const double HALF_PI = 3.14159265359 / 2;
+        double k = std::round(phi / HALF_PI);
+        if (std::abs(phi - k * HALF_PI) > 1e-9) {
+            return false;
+        }
+        quarters = ((int)std::fmod(k, 4) + 4) % 4;
+        return true;
+    }
+
+    /**
+     * hàm xoay ảnh một bội của 90 độ, cùng chiều với hàm rotate trong algos.h
+     * @src: ảnh nguồn
+     * @k: số lần xoay 90 độ, có thể âm
+     * @return: ảnh đã xoay
+     */
+    static cv::Mat rotate90(Img src, int k) {
+        k = ((k % 4) + 4) % 4;
+        if (k == 0) {
+            return src.clone();
+        }
+        if (k == 2) {
+            return flip(src, true, true);
+        }
+
+        // xoay 1 lần: pixel (i, j) của ảnh mới là pixel (rows - 1 - j, i) của ảnh cũ,
+        // xoay 3 lần: pixel (i, j) của ảnh mới là pixel (j, cols - 1 - i) của ảnh cũ
+        return transpose(src, k == 1, k == 3);
+    }
+
+    /**
+     * hàm lật ảnh
+     * @src: ảnh nguồn
+     * @flip_rows: đảo thứ tự các dòng
+     * @flip_cols: đảo thứ tự các cột
+     * @return: ảnh đã lật
+     */
+    static cv::Mat flip(Img src, bool flip_rows, bool flip_cols) {
+        cv::Mat dst(src.size(), src.type());
+        size_t ps = src.elemSize();
+        cv::parallel_for_(cv::Range(0, src.rows), [&](const cv::Range& range) {
+            for (int i = range.start; i < range.end; ++i) {
+                const uchar* p = src.ptr<uchar>(flip_rows ? src.rows - 1 - i : i);
+                uchar* q = dst.ptr<uchar>(i);
+                if (!flip_cols) {
+                    std::memcpy(q, p, src.cols * ps);
+                    continue;
+                }
+                switch (ps) {
+                    case 1: reverse<1>(p, q, src.cols); break;
+                    case 3: reverse<3>(p, q, src.cols); break;
+                    case 4: reverse<4>(p, q, src.cols); break;
+                    default: reverseAny(p, q, src.cols, ps); break;
+                }
+            }
+        });
+        return dst;
+    }
+
+    /**
+     * hàm lật ảnh theo mã chuỗi, dùng cho tham số dòng lệnh
+     * @src: ảnh nguồn
+     * @mode: FLIP_MD_X, FLIP_MD_Y hoặc FLIP_MD_XY
+     * @return: ảnh đã lật
+     */
+    static cv::Mat flip(Img src, const std::string& mode) {
+        if (mode != FLIP_MD_X && mode != FLIP_MD_Y && mode != FLIP_MD_XY) {
+            throw std::runtime_error("Khong ho tro kieu lat " + mode);
+        }
+        return flip(src, mode != FLIP_MD_Y, mode != FLIP_MD_X);
+    }
+
+    /**
+     * hàm chuyển vị ảnh theo từng khối, có thể lật kèm theo
+     * pixel (i, j) của ảnh mới là pixel (x, y) của ảnh cũ với x = j hoặc rows - 1 - j, y = i hoặc cols - 1 - i
+     * @src: ảnh nguồn
+     * @flip_rows: lấy dòng nguồn theo thứ tự ngược
+     * @flip_cols: lấy cột nguồn theo thứ tự ngược
+     * @return: ảnh kích thước src.rows x src.cols (rộng x cao)
+     */
+    static cv::Mat transpose(Img src, bool flip_rows = false, bool flip_cols = false) {
+        cv::Mat dst(src.cols, src.rows, src.type());
+        switch (src.elemSize()) {
+            case 1: transposeBlocks<1>(src, dst, flip_rows, flip_cols); break;
+            case 3: transposeBlocks<3>(src, dst, flip_rows, flip_cols); break;
+            case 4: transposeBlocks<4>(src, dst, flip_rows, flip_cols); break;
+            default: transposeBlocks<0>(src, dst, flip_rows, flip_cols); break;
+        }
+        return dst;
+    }
+
+private:
+    // chép một pixel PS byte, PS = 0 nghĩa là kích thước pixel chỉ biết lúc chạy
+    template <int PS>
+    static void copyPixel(const uchar* p, uchar* q, size_t ps) {
+        std::memcpy(q, p, PS ? PS : ps);
+    }
+
+    // chép n pixel PS byte theo thứ tự ngược
+    template <int PS>
+    static void reverse(const uchar* p, uchar* q, int n) {
+        const uchar* s = p + (n - 1) * PS;
+        for (int j = 0; j < n; ++j, s -= PS, q += PS) {
+            copyPixel<PS>(s, q, PS);
+        }
+    }
+
+    static void reverseAny(const uchar* p, uchar* q, int n, size_t ps) {
+        const uchar* s = p + (n - 1) * ps;
+        for (int j = 0; j < n; ++j, s -= ps, q += ps) {
+            std::memcpy(q, s, ps);
+        }
+    }
+
+    // phần thân của transpose, kích thước pixel là tham số khuôn mẫu để phép chép được trải thành vài lệnh
+    // mỗi luồng nhận một dải BLOCK dòng nguồn và duyệt các khối theo chiều ngang của dải
+    template <int PS>
+    static void transposeBlocks(Img src, cv::Mat& dst, bool flip_rows, bool flip_cols) {
+        size_t ps = src.elemSize();
+        int bands = (src.rows + BLOCK - 1) / BLOCK;
+        cv::parallel_for_(cv::Range(0, bands), [&](const cv::Range& range) {
+            for (int b = range.start; b < range.end; ++b) {
+                int i0 = b * BLOCK, i1 = i0 + BLOCK < src.rows ? i0 + BLOCK : src.rows;
+                for (int j0 = 0; j0 < src.cols; j0 += BLOCK) {
+                    int j1 = j0 + BLOCK < src.cols ? j0 + BLOCK : src.cols;
+                    for (int i = i0; i < i1; ++i) {
+                        const uchar* p = src.ptr<uchar>(i) + j0 * ps;
+
+                        // pixel nguồn (i, j) nằm ở cột dc của dòng (flip_cols ? cols - 1 - j : j) trên ảnh mới
+                        int dc = flip_rows ? src.rows - 1 - i : i;
+                        for (int j = j0; j < j1; ++j, p += ps) {
+                            int dr = flip_cols ? src.cols - 1 - j : j;
+                            copyPixel<PS>(p, dst.ptr<uchar>(dr) + dc * ps, ps);
+                        }
+                    }
+                }
+            }
+        });
+    }
+};
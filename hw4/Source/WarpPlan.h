@@ -0,0 +1,233 @@
+#pragma once
+#include <cmath>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <climits>
+#include <stdexcept>
+#include <algorithm>
+#include "AffineWarper.h"
+#include "RemapTable.h"
+#include "Transposer.h"
+#include "opencv2/core/core.hpp"
+
+// lớp kế hoạch biến đổi hình học lười
+// các bước xoay, co giãn, tịnh tiến, cắt chỉ được ghi lại: mỗi bước là một phép affine 2 x 3 từ tọa độ ảnh trước
+// sang tọa độ ảnh sau (x là dòng, y là cột), kèm kích thước ảnh sau; khi thực thi, mọi bước được gộp thành
+// một ma trận duy nhất và ảnh nguồn chỉ bị lấy mẫu lại đúng một lần
+// mỗi bước cho cùng kích thước và vị trí ảnh như khi gọi lần lượt các hàm rotate, rotateN, scale, crop trong algos.h,
+// kể cả phép xoay bội của 90 độ: bước đó là một hoán vị chính xác với kích thước cols x rows như Transposer::rotate90
+class WarpPlan {
+    // ánh xạ từ tọa độ ảnh nguồn sang tọa độ ảnh hiện tại, dạng 3 x 3 với dòng cuối (0, 0, 1)
+    cv::Matx33d map;
+
+    // kích thước ảnh hiện tại
+    cv::Size size;
+public:
+    /**
+     * hàm khởi tạo kế hoạch rỗng
+     * @input_size: kích thước ảnh nguồn
+     */
+    WarpPlan(cv::Size input_size) : map(cv::Matx33d::eye()), size(input_size) {}
+
+    // phương thức lấy kích thước ảnh kết quả
+    cv::Size getSize() const {
+        return size;
+    }
+
+    // phương thức lấy ánh xạ gộp từ tọa độ ảnh nguồn sang tọa độ ảnh kết quả
+    cv::Matx23d getMap() const {
+        return cv::Matx23d(map(0, 0), map(0, 1), map(0, 2), map(1, 0), map(1, 1), map(1, 2));
+    }
+
+    // phương thức lấy ánh xạ ngược từ tọa độ ảnh kết quả về tọa độ ảnh nguồn
+    cv::Matx23d inverseMap() const {
+        auto inv = map.inv();
+        return cv::Matx23d(inv(0, 0), inv(0, 1), inv(0, 2), inv(1, 0), inv(1, 1), inv(1, 2));
+    }
+
+    // hàm tạo ma trận xoay góc @phi (radian), cùng chiều với hàm rotate trong algos.h
+    static cv::Matx22d rotationMatrix(double phi) {
+        return cv::Matx22d(std::cos(phi), std::sin(phi), -std::sin(phi), std::cos(phi));
+    }
+
+    /**
+     * phương thức thêm một phép biến đổi tuyến tính, ảnh sau là hình bao của ảnh trước sau khi biến đổi
+     * hình bao được tính giống transformedRect trong algos.h
+     * @mat: ma trận 2 x 2
+     * @return: *this
+     */
+    WarpPlan& transform(const cv::Matx22d& mat) {
+        int xmin = INT_MAX, ymin = INT_MAX, xmax = INT_MIN, ymax = INT_MIN;
+        for (int x = 0; x < 2; ++x) {
+            for (int y = 0; y < 2; ++y) {
+                auto pos = mat * cv::Matx21d(x * size.height, y * size.width);
+                xmax = std::max(xmax, (int)std::round(pos(0, 0)));
+                xmin = std::min(xmin, (int)std::round(pos(0, 0)));
+                ymax = std::max(ymax, (int)std::round(pos(1, 0)));
+                ymin = std::min(ymin, (int)std::round(pos(1, 0)));
+            }
+        }
+
+        // gốc ảnh sau là góc trên trái của hình bao
+        map = cv::Matx33d(mat(0, 0), mat(0, 1), -xmin,
+                          mat(1, 0), mat(1, 1), -ymin,
+                          0, 0, 1) * map;
+        size = cv::Size(ymax - ymin + 1, xmax - xmin + 1);
+        return *this;
+    }
+
+    /**
+     * phương thức thêm phép xoay bảo toàn
+     * góc là bội của 90 độ thì bước xoay là hoán vị pixel giống Transposer::rotate90, không có hình bao thừa
+     * @phi: góc xoay (radian)
+     * @return: *this
+     */
+    WarpPlan& rotate(double phi) {
+        int quarters;
+        if (!Transposer::isRightAngle(phi, quarters)) {
+            return transform(rotationMatrix(phi));
+        }
+
+        // pixel (x, y) của ảnh trước đến vị trí của nó sau khi xoay quarters lần 90 độ
+        int rows = size.height, cols = size.width;
+        cv::Matx33d step = cv::Matx33d::eye();
+        switch (quarters) {
+            case 1: step = cv::Matx33d(0, 1, 0, -1, 0, rows - 1, 0, 0, 1); break;
+            case 2: step = cv::Matx33d(-1, 0, rows - 1, 0, -1, cols - 1, 0, 0, 1); break;
+            case 3: step = cv::Matx33d(0, -1, cols - 1, 1, 0, 0, 0, 0, 1); break;
+        }
+        map = step * map;
+        if (quarters % 2) {
+            size = cv::Size(rows, cols);
+        }
+        return *this;
+    }
+
+    /**
+     * phương thức thêm phép xoay không bảo toàn: xoay rồi cắt phần giữa theo kích thước trước khi xoay
+     * phần giữa được lấy trên hình bao của phép xoay như hàm rotateN trong algos.h, kể cả với góc bội của 90 độ
+     * @phi: góc xoay (radian)
+     * @return: *this
+     */
+    WarpPlan& rotateN(double phi) {
+        cv::Size before = size;
+        transform(rotationMatrix(phi));
+        return crop(size.height / 2, size.width / 2, before.height, before.width);
+    }
+
+    /**
+     * phương thức thêm phép co giãn
+     * @xscale: tỉ lệ theo trục x
+     * @yscale: tỉ lệ theo trục y
+     * @return: *this
+     */
+    WarpPlan& scale(double xscale, double yscale) {
+        return transform(cv::Matx22d(xscale, 0, 0, yscale));
+    }
+
+    /**
+     * phương thức thêm phép tịnh tiến nội dung ảnh, kích thước ảnh giữ nguyên
+     * @dx: độ dời theo trục x (dòng)
+     * @dy: độ dời theo trục y (cột)
+     * @return: *this
+     */
+    WarpPlan& translate(double dx, double dy) {
+        map = cv::Matx33d(1, 0, dx, 0, 1, dy, 0, 0, 1) * map;
+        return *this;
+    }
+
+    /**
+     * phương thức thêm phép cắt, cùng tham số với hàm crop trong algos.h
+     * @gx, @gy: tọa độ tâm hình chữ nhật cắt ra
+     * @height, @width: kích thước hình chữ nhật
+     * @return: *this
+     */
+    WarpPlan& crop(int gx, int gy, int height, int width) {
+        map = cv::Matx33d(1, 0, -(gx - height / 2), 0, 1, -(gy - width / 2), 0, 0, 1) * map;
+        size = cv::Size(width, height);
+        return *this;
+    }
+
+    /**
+     * phương thức thực thi kế hoạch: lấy mẫu lại ảnh nguồn một lần theo ánh xạ gộp
+     * @img: ảnh nguồn, cùng kích thước với input_size lúc khởi tạo
+     * @sampler: cách nội suy và kiểu biên
+     * @return: ảnh kết quả
+     */
+    cv::Mat execute(Img img, const Sampler& sampler = Sampler()) const {
+        return AffineWarper(inverseMap(), sampler).warp(img, size);
+    }
+
+    /**
+     * phương thức thực thi kế hoạch qua bảng ánh xạ tính sẵn, dùng khi kế hoạch được áp dụng lên nhiều khung hình
+     * @img: ảnh nguồn, cùng kích thước với input_size lúc khởi tạo
+     * @cache: bộ nhớ đệm bảng ánh xạ, dùng chung giữa các lần gọi
+     * @sampler: cách nội suy và kiểu biên
+     * @return: ảnh kết quả, giống hệt execute(img, sampler)
+     */
+    cv::Mat execute(Img img, RemapCache& cache, const Sampler& sampler = Sampler()) const {
+        return cache.get(inverseMap(), img.size(), size, sampler)->apply(img);
+    }
+
+    /**
+     * hàm tạo kế hoạch từ chuỗi các bước, các bước cách nhau bởi ';', tên bước và tham số cách nhau bởi ':',
+     * các tham số cách nhau bởi ',', góc xoay tính bằng độ, ví dụ: "scale:2,1.5;rotate:30;crop:100,120,80,80"
+     * các bước hỗ trợ: rotate:phi, rotateN:phi, scale:xscale,yscale, translate:dx,dy, crop:gx,gy,height,width
+     * @steps: chuỗi các bước
+     * @input_size: kích thước ảnh nguồn
+     * @return: kế hoạch tương ứng
+     */
+    static WarpPlan parse(const std::string& steps, cv::Size input_size) {
+        const double PI = 3.14159265359;
+        WarpPlan plan(input_size);
+
+        std::stringstream ss(steps);
+        std::string step;
+        while (std::getline(ss, step, ';')) {
+            if (step.empty()) {
+                continue;
+            }
+            auto colon = step.find(':');
+            std::string name = step.substr(0, colon);
+            std::vector<double> args;
+            if (colon != std::string::npos) {
+                std::stringstream as(step.substr(colon + 1));
+                std::string arg;
+                while (std::getline(as, arg, ',')) {
+                    args.push_back(std::stod(arg));
+                }
+            }
+
+            auto expect = [&](size_t n) {
+                if (args.size() != n) {
+                    throw std::runtime_error("Buoc " + name + " can " + std::to_string(n) + " tham so");
+                }
+            };
+            if (name == "rotate") {
+                expect(1);
+                plan.rotate(args[0] * PI / 180);
+            }
+            else if (name == "rotateN") {
+                expect(1);
+                plan.rotateN(args[0] * PI / 180);
+            }
+            else if (name == "scale") {
+                expect(2);
+                plan.scale(args[0], args[1]);
+            }
+            else if (name == "translate") {
+                expect(2);
+                plan.translate(args[0], args[1]);
+            }
+            else if (name == "crop") {
+                expect(4);
+                plan.crop((int)args[0], (int)args[1], (int)args[2], (int)args[3]);
+            }
+            else {
+                throw std::runtime_error("Khong ho tro buoc bien doi " + name);
+            }
+        }
+        return plan;
+    }
+};
@@ -3,6 +3,12 @@
 #include <tuple>
 #include <cassert>
 #include "opencv2/core/core.hpp"
+#include "AffineWarper.h"
+#include "PerspectiveWarper.h"
+#include "WarpPlan.h"
+#include "RemapTable.h"
+#include "Resizer.h"
+#include "Transposer.h"
 #include "opencv2/highgui/highgui.hpp" // cần các hàm cv::imread, cv::imwrite, cv::imshow, cv::waitKey, cv::namedWindow
 #include "opencv2/imgproc/imgproc.hpp" // cần hàm cvtColor
 #include <cmath>
@@ -40,6 +46,48 @@ cv::Rect transformedRect(int width, int height, Matx transform_mat) {
     return {ymin, xmin, ymax - ymin + 1, xmax - xmin + 1};
 }
 
+/**
+ * hàm lấy vùng không gian ảnh sau phép biến đổi phối cảnh, tọa độ mới của mỗi góc là (x' / w', y' / w')
+ * @width: chiều rộng ban đầu
+ * @height: chiều cao ban đầu
+ * @transform_mat: ma trận biến đổi 3 x 3
+ * @return: hình chữ nhật mô tả vùng không gian sau khi biến đổi
+ */
+cv::Rect transformedRect(int width, int height, const cv::Matx33d& transform_mat) {
+    int xmin = INT_MAX, ymin = INT_MAX, xmax = INT_MIN, ymax = INT_MIN;
+    for (int x = 0; x < 2; ++x) {
+        for (int y = 0; y < 2; ++y) {
+            auto newPos = transform_mat * cv::Matx31d(x * height, y * width, 1);
+            if (newPos(2, 0) <= 0) {
+                throw std::runtime_error("Phep bien doi phoi canh dua goc anh ra vo cuc");
+            }
+            auto xnew = std::round(newPos(0, 0) / newPos(2, 0));
+            auto ynew = std::round(newPos(1, 0) / newPos(2, 0));
+            xmax = std::max(xmax, (int)xnew);
+            xmin = std::min(xmin, (int)xnew);
+            ymax = std::max(ymax, (int)ynew);
+            ymin = std::min(ymin, (int)ynew);
+        }
+    }
+    return {ymin, xmin, ymax - ymin + 1, xmax - xmin + 1};
+}
+
+/**
+ * hàm tính ánh xạ ngược từ tọa độ pixel trên ảnh kết quả về tọa độ trên ảnh nguồn
+ * ma trận biến đổi nghịch đảo là ma trận nghịch đảo của ma trận biến đổi; pixel (i, j) trên ảnh kết quả
+ * ứng với tọa độ (i + out_rect.y, j + out_rect.x) trên ảnh mới, nên phần tịnh tiến là inv_mat * (out_rect.y, out_rect.x)
+ * @transform_mat: ma trận biến đổi
+ * @out_rect: vùng ảnh kết quả trên không gian ảnh mới, cùng quy ước với transformedRect (x là cột, y là dòng)
+ * @return: ma trận 2 x 3
+ */
+template <class Matx>
+cv::Matx23d inverseMap(Matx transform_mat, const cv::Rect& out_rect) {
+    auto inv_mat = transform_mat.inv();
+    auto offset = inv_mat * cv::Matx21d(out_rect.y, out_rect.x);
+    return cv::Matx23d(inv_mat(0, 0), inv_mat(0, 1), offset(0, 0),
+                       inv_mat(1, 0), inv_mat(1, 1), offset(1, 0));
+}
+
 /**
  * hàm áp dụng phép biến đổi hình học lên ảnh
  * thuật toán:
@@ -47,61 +95,198 @@ cv::Rect transformedRect(int width, int height, Matx transform_mat) {
  *     - B2: với mỗi pixel trên ảnh mới:
  *         + Tìm pixel tương ứng trên ảnh cũ bằng phép biến đổi nghịch đảo
  *         + Tính giá trị nội suy của pixel mới bằng 4 pixel lân cận trên ảnh cũ
+ * bước 2 được thực hiện theo từng dòng quét bằng AffineWarper: phép biến đổi nghịch đảo là affine nên
+ * tọa độ cũ chỉ cần tính một lần ở đầu dòng, các pixel sau cộng thêm một bước cố định
  * @img: ảnh đầu vào
  * @transform_mat: ma trận biến đổi
- * @return: ảnh sau khi biến đổi
+ * @dst: ảnh kết quả, được tạo lại nếu chưa đúng kích thước; có thể trùng @img
+ * @sampler: cách nội suy và kiểu biên
  */
 template <class Matx>
-cv::Mat applyTransform(Img img, Matx transform_mat) {
+void applyTransform(Img img, Matx transform_mat, cv::Mat& dst, const Sampler& sampler = Sampler()) {
     // tính vùng không gian ảnh mới
     cv::Rect transformed_region = transformedRect(img.cols, img.rows, transform_mat);
-    
-    // ảnh kết quả
-    cv::Mat res(transformed_region.size(), CV_8UC3);
-    
-    auto f = [&] (int x, int y) -> cv::Vec3b {
-        if (x >= 0 && x < img.rows && y >= 0 && y < img.cols) {
-            return img.at<cv::Vec3b>(x, y);
-        }
-        return cv::Vec3b(0, 0, 0);
-    };
-    auto g = [&] (int x, int y) -> cv::Vec3b& {
-        return res.at<cv::Vec3b>(x, y);
-    };
-    
-    // ma trận biến đổi nghịch đảo là ma trận nghịch đảo của ma trận biến đổi
-    auto inv_mat = transform_mat.inv();
 
-    // với mỗi pixel trên ảnh kết quả
-    for (int xnew = transformed_region.y; xnew < transformed_region.y + transformed_region.height; ++xnew) {
-        for (int ynew = transformed_region.x; ynew < transformed_region.x + transformed_region.width; ++ynew) {
-            // biến đổi ngược tọa độ để tìm tọa độ tương ứng trên ảnh cũ
-            auto oldPos = inv_mat * cv::Matx21d(xnew, ynew);
-            auto xold = oldPos(0, 0);
-            auto yold = oldPos(1, 0);
-
-            int x = std::round(xold);
-            int y = std::round(yold);
-            
-            double a = xold - x;
-            double b = yold - y;
-
-            // trên mỗi kênh màu, nội suy giá trị pixel mới bằng 4 pixel cũ
-            for (int c = 0; c < img.channels(); ++c) {
-                g(xnew - transformed_region.y, ynew - transformed_region.x)[c] = cv::saturate_cast<uchar>(
-                                              (1 - a) * (1 - b) * f(x, y)[c]
-                                            + a * (1 - b) * f(x + 1, y)[c]
-                                            + (1 - a) * b * f(x, y + 1)[c]
-                                            + a * b * f(x + 1, y + 1)[c]);
-            }
+    applyTransform(img, transform_mat, transformed_region, dst, sampler);
+}
+
+/**
+ * hàm áp dụng phép biến đổi hình học lên ảnh
+ * @img: ảnh đầu vào
+ * @transform_mat: ma trận biến đổi
+ * @sampler: cách nội suy và kiểu biên
+ * @return: ảnh sau khi biến đổi
+ */
+template <class Matx>
+cv::Mat applyTransform(Img img, Matx transform_mat, const Sampler& sampler = Sampler()) {
+    cv::Mat res;
+    applyTransform(img, transform_mat, res, sampler);
+    return res;
+}
+
+/**
+ * hàm áp dụng phép biến đổi hình học lên ảnh, chỉ tính những pixel nằm trong một vùng cho trước của không gian ảnh mới
+ * vùng này không nhất thiết nằm trong transformedRect, pixel không có ảnh nguồn tương ứng được xử lý theo kiểu biên
+ * @img: ảnh đầu vào
+ * @transform_mat: ma trận biến đổi
+ * @out_rect: vùng cần tính trên không gian ảnh mới, cùng quy ước với transformedRect (x là cột, y là dòng)
+ * @dst: ảnh kích thước @out_rect.size(), pixel (i, j) ứng với tọa độ (i + out_rect.y, j + out_rect.x) trên ảnh mới;
+ *       được tạo lại nếu chưa đúng kích thước, có thể trùng @img
+ * @sampler: cách nội suy và kiểu biên
+ */
+template <class Matx>
+void applyTransform(Img img, Matx transform_mat, const cv::Rect& out_rect, cv::Mat& dst, const Sampler& sampler = Sampler()) {
+    AffineWarper(inverseMap(transform_mat, out_rect), sampler).warp(img, out_rect.size(), dst);
+}
+
+/**
+ * hàm áp dụng phép biến đổi hình học lên ảnh, chỉ tính những pixel nằm trong một vùng cho trước của không gian ảnh mới
+ * @img: ảnh đầu vào
+ * @transform_mat: ma trận biến đổi
+ * @out_rect: vùng cần tính trên không gian ảnh mới, cùng quy ước với transformedRect (x là cột, y là dòng)
+ * @sampler: cách nội suy và kiểu biên
+ * @return: ảnh kích thước @out_rect.size()
+ */
+template <class Matx>
+cv::Mat applyTransform(Img img, Matx transform_mat, const cv::Rect& out_rect, const Sampler& sampler = Sampler()) {
+    cv::Mat res;
+    applyTransform(img, transform_mat, out_rect, res, sampler);
+    return res;
+}
+
+/**
+ * hàm áp dụng phép biến đổi hình học lên ảnh qua bảng ánh xạ tính sẵn
+ * dùng khi cùng một phép biến đổi được áp dụng lên nhiều ảnh cùng kích thước (các khung hình của một chuỗi):
+ * lần đầu tính bảng tọa độ nguồn và lưu vào @cache, các lần sau chỉ đọc lại bảng; kết quả giống hệt applyTransform
+ * @img: ảnh đầu vào
+ * @transform_mat: ma trận biến đổi
+ * @cache: bộ nhớ đệm bảng ánh xạ, dùng chung giữa các lần gọi
+ * @dst: ảnh kết quả, được tạo lại nếu chưa đúng kích thước nên các khung hình sau dùng lại được bộ nhớ; có thể trùng @img
+ * @sampler: cách nội suy và kiểu biên
+ */
+template <class Matx>
+void applyTransformCached(Img img, Matx transform_mat, RemapCache& cache, cv::Mat& dst, const Sampler& sampler = Sampler()) {
+    cv::Rect out_rect = transformedRect(img.cols, img.rows, transform_mat);
+    cache.get(inverseMap(transform_mat, out_rect), img.size(), out_rect.size(), sampler)->apply(img, dst);
+}
+
+/**
+ * hàm áp dụng phép biến đổi hình học lên ảnh qua bảng ánh xạ tính sẵn
+ * @img: ảnh đầu vào
+ * @transform_mat: ma trận biến đổi
+ * @cache: bộ nhớ đệm bảng ánh xạ, dùng chung giữa các lần gọi
+ * @sampler: cách nội suy và kiểu biên
+ * @return: ảnh sau khi biến đổi
+ */
+template <class Matx>
+cv::Mat applyTransformCached(Img img, Matx transform_mat, RemapCache& cache, const Sampler& sampler = Sampler()) {
+    cv::Mat res;
+    applyTransformCached(img, transform_mat, cache, res, sampler);
+    return res;
+}
+
+/**
+ * hàm áp dụng phép biến đổi phối cảnh lên ảnh, chỉ tính những pixel nằm trong một vùng cho trước của không gian ảnh mới
+ * ánh xạ ngược vẫn là một phép phối cảnh nên được tính theo từng dòng quét bằng PerspectiveWarper
+ * @img: ảnh đầu vào
+ * @transform_mat: ma trận biến đổi 3 x 3 trên tọa độ thuần nhất (x, y, 1)
+ * @out_rect: vùng cần tính trên không gian ảnh mới, cùng quy ước với transformedRect (x là cột, y là dòng)
+ * @dst: ảnh kích thước @out_rect.size(), được tạo lại nếu chưa đúng kích thước; có thể trùng @img
+ * @sampler: cách nội suy và kiểu biên
+ */
+void applyTransform(Img img, const cv::Matx33d& transform_mat, const cv::Rect& out_rect, cv::Mat& dst, const Sampler& sampler = Sampler()) {
+    cv::Matx33d offset(1, 0, out_rect.y, 0, 1, out_rect.x, 0, 0, 1);
+    PerspectiveWarper(transform_mat.inv() * offset, sampler).warp(img, out_rect.size(), dst);
+}
+
+/**
+ * hàm áp dụng phép biến đổi phối cảnh lên ảnh, chỉ tính những pixel nằm trong một vùng cho trước của không gian ảnh mới
+ * @img: ảnh đầu vào
+ * @transform_mat: ma trận biến đổi 3 x 3 trên tọa độ thuần nhất (x, y, 1)
+ * @out_rect: vùng cần tính trên không gian ảnh mới, cùng quy ước với transformedRect (x là cột, y là dòng)
+ * @sampler: cách nội suy và kiểu biên
+ * @return: ảnh kích thước @out_rect.size()
+ */
+cv::Mat applyTransform(Img img, const cv::Matx33d& transform_mat, const cv::Rect& out_rect, const Sampler& sampler = Sampler()) {
+    cv::Mat res;
+    applyTransform(img, transform_mat, out_rect, res, sampler);
+    return res;
+}
+
+/**
+ * hàm áp dụng phép biến đổi phối cảnh lên ảnh, ảnh mới là hình bao của ảnh 4 góc, vào ảnh cho trước
+ * @img: ảnh đầu vào
+ * @transform_mat: ma trận biến đổi 3 x 3 trên tọa độ thuần nhất (x, y, 1)
+ * @dst: ảnh kết quả, được tạo lại nếu chưa đúng kích thước; có thể trùng @img
+ * @sampler: cách nội suy và kiểu biên
+ */
+void applyTransform(Img img, const cv::Matx33d& transform_mat, cv::Mat& dst, const Sampler& sampler = Sampler()) {
+    applyTransform(img, transform_mat, transformedRect(img.cols, img.rows, transform_mat), dst, sampler);
+}
+
+/**
+ * hàm áp dụng phép biến đổi phối cảnh lên ảnh, ảnh mới là hình bao của ảnh 4 góc
+ * @img: ảnh đầu vào
+ * @transform_mat: ma trận biến đổi 3 x 3 trên tọa độ thuần nhất (x, y, 1)
+ * @sampler: cách nội suy và kiểu biên
+ * @return: ảnh sau khi biến đổi
+ */
+cv::Mat applyTransform(Img img, const cv::Matx33d& transform_mat, const Sampler& sampler = Sampler()) {
+    cv::Mat res;
+    applyTransform(img, transform_mat, res, sampler);
+    return res;
+}
+
+/**
+ * hàm tìm ma trận phối cảnh biến 4 điểm @src thành 4 điểm @dst
+ * mỗi cặp điểm cho 2 phương trình tuyến tính theo 8 hệ số (hệ số cuối cố định bằng 1)
+ * @src, @dst: mỗi mảng 4 điểm, point.x là chỉ số dòng, point.y là chỉ số cột
+ * @return: ma trận 3 x 3
+ */
+cv::Matx33d perspectiveMat(const cv::Point2d src[4], const cv::Point2d dst[4]) {
+    cv::Matx<double, 8, 8> a;
+    cv::Matx<double, 8, 1> b;
+    for (int i = 0; i < 4; ++i) {
+        double x = src[i].x, y = src[i].y, u = dst[i].x, v = dst[i].y;
+        double row_u[] = {x, y, 1, 0, 0, 0, -x * u, -y * u};
+        double row_v[] = {0, 0, 0, x, y, 1, -x * v, -y * v};
+        for (int j = 0; j < 8; ++j) {
+            a(2 * i, j) = row_u[j];
+            a(2 * i + 1, j) = row_v[j];
         }
+        b(2 * i, 0) = u;
+        b(2 * i + 1, 0) = v;
     }
+    auto h = a.solve(b, cv::DECOMP_LU);
+    return cv::Matx33d(h(0, 0), h(1, 0), h(2, 0), h(3, 0), h(4, 0), h(5, 0), h(6, 0), h(7, 0), 1);
+}
 
-    return res;
+/**
+ * hàm chỉnh méo phối cảnh (keystone): kéo tứ giác @corners trên ảnh về một hình chữ nhật thẳng
+ * @img: ảnh đầu vào
+ * @corners: 4 góc theo thứ tự trên trái, trên phải, dưới phải, dưới trái; point.x là dòng, point.y là cột
+ * @height, @width: kích thước ảnh kết quả, <= 0 thì lấy theo cạnh dài hơn của tứ giác
+ * @sampler: cách nội suy và kiểu biên
+ * @return: ảnh đã chỉnh
+ */
+cv::Mat keystone(Img img, const cv::Point2d corners[4], int height = 0, int width = 0, const Sampler& sampler = Sampler()) {
+    auto dist = [&](int i, int j) {
+        return std::hypot(corners[i].x - corners[j].x, corners[i].y - corners[j].y);
+    };
+    if (width <= 0) {
+        width = (int)std::round(std::max(dist(0, 1), dist(3, 2))) + 1;
+    }
+    if (height <= 0) {
+        height = (int)std::round(std::max(dist(0, 3), dist(1, 2))) + 1;
+    }
+
+    cv::Point2d rect[4] = {{0, 0}, {0, width - 1.0}, {height - 1.0, width - 1.0}, {height - 1.0, 0}};
+    return applyTransform(img, perspectiveMat(corners, rect), cv::Rect(0, 0, width, height), sampler);
 }
 
 /**
  * hàm cắt ảnh: cắt lấy 1 vùng hình chữ nhật của ảnh
+ * kết quả là một ROI dùng chung dữ liệu với @img, không sao chép pixel; cần clone() nếu muốn sửa độc lập
  * @img: ảnh đầu vào
  * @gx: tọa độ x của tâm hình chữ nhật sẽ cắt ra
  * @gy: tọa độ y của tâm hình chữ nhật sẽ cắt ra
@@ -110,41 +295,44 @@ cv::Mat applyTransform(Img img, Matx transform_mat) {
  * @return: ảnh đã được cắt
  */
 cv::Mat crop(Img img, int gx, int gy, int height, int width) {
-    cv::Mat res(height, width, CV_8UC3);
-
-    for (int i = 0; i < res.rows; ++i) {
-        for (int j = 0; j < res.cols; ++j) {
-            res.at<cv::Vec3b>(i, j) = img.at<cv::Vec3b>(gx - height / 2 + i, gy - width / 2 + j);
-        }
-    }
-    return res;
+    return img(cv::Rect(gy - width / 2, gx - height / 2, width, height));
 }
 
 /**
  * hàm xoay ảnh bảo toàn kích thước
+ * góc là bội của 90 độ thì ảnh được hoán vị chính xác bằng Transposer, kích thước mới đúng bằng cols x rows
  * @img: ảnh đầu vào
  * @phi: góc xoay
+ * @sampler: cách nội suy và kiểu biên
  * @return: ảnh đã xoay
  */
-cv::Mat rotate(Img img, double phi) {
-    cv::Mat res;
-    
+cv::Mat rotate(Img img, double phi, const Sampler& sampler = Sampler()) {
+    // góc là bội của 90 độ: ảnh mới chỉ là hoán vị pixel của ảnh cũ, không cần nội suy
+    int quarters;
+    if (Transposer::isRightAngle(phi, quarters)) {
+        return Transposer::rotate90(img, quarters);
+    }
+
     // áp dụng ma trận phép xoay lên ảnh
     cv::Matx22d rotate_mat(std::cos(phi), std::sin(phi), -std::sin(phi), std::cos(phi)); 
-    return applyTransform(img, rotate_mat);
+    return applyTransform(img, rotate_mat, sampler);
 }
 
 /**
  * hàm xoay ảnh không bảo toàn kích thước
  * @img: ảnh đầu vào
  * @phi: góc xoay
+ * @sampler: cách nội suy và kiểu biên
  * @return: ảnh đã xoay
  */
-cv::Mat rotateN(Img img, double phi) {
-    // xoay ảnh có bảo toàn
-    auto rotated = rotate(img, phi);
-    // sau đó cắt phần ảnh ở giữa theo kích thước ban đầu ra
-    return crop(rotated, rotated.rows / 2, rotated.cols / 2, img.rows, img.cols);
+cv::Mat rotateN(Img img, double phi, const Sampler& sampler = Sampler()) {
+    cv::Matx22d rotate_mat(std::cos(phi), std::sin(phi), -std::sin(phi), std::cos(phi));
+
+    // vùng ở giữa ảnh xoay bảo toàn có kích thước bằng ảnh ban đầu, giống crop(rotate(img, phi), ...)
+    // nhưng chỉ những pixel trong vùng này được tính
+    cv::Rect region = transformedRect(img.cols, img.rows, rotate_mat);
+    cv::Rect center(region.x + region.width / 2 - img.cols / 2, region.y + region.height / 2 - img.rows / 2, img.cols, img.rows);
+    return applyTransform(img, rotate_mat, center, sampler);
 }
 
 /**
@@ -152,10 +340,82 @@ cv::Mat rotateN(Img img, double phi) {
  * @img: ảnh đầu vào
  * @xscale: tỉ lệ thay đổi theo trục x
  * @yscale: tỉ lệ thay đổi theo trục y
+ * @sampler: cách nội suy và kiểu biên
  * @return: ảnh đã thay đổi kích thước
  */
-cv::Mat scale(Img img, double xscale, double yscale) {
+cv::Mat scale(Img img, double xscale, double yscale, const Sampler& sampler = Sampler()) {
     // áp dụng ma trận phép co giãn lên ảnh
     cv::Matx22d scale_mat(xscale, 0, 0, yscale);
-    return applyTransform(img, scale_mat);
+    return applyTransform(img, scale_mat, sampler);
+}
+
+/**
+ * hàm thay đổi kích thước ảnh bằng bộ lọc tách được của Resizer, kích thước mới được làm tròn như cv::resize
+ * khác với scale, ảnh không đi qua phép biến đổi tổng quát và khi thu nhỏ mỗi pixel mới lấy từ mọi pixel cũ
+ * mà nó phủ lên nên không bị răng cưa
+ * @img: ảnh đầu vào
+ * @xscale: tỉ lệ thay đổi theo trục x
+ * @yscale: tỉ lệ thay đổi theo trục y
+ * @kernel: RESIZE_MD_AREA hoặc RESIZE_MD_LANCZOS
+ * @return: ảnh đã thay đổi kích thước
+ */
+cv::Mat resize(Img img, double xscale, double yscale, const std::string& kernel = RESIZE_MD_AREA) {
+    cv::Size size(std::max(1, (int)std::round(img.cols * yscale)), std::max(1, (int)std::round(img.rows * xscale)));
+    return Resizer(kernel).apply(img, size);
+}
+
+/**
+ * hàm tính sai số lớn nhất trên từng pixel giữa 2 ảnh CV_8UC(n) cùng kích thước
+ * @a, @b: 2 ảnh cần so sánh
+ * @return: sai số lớn nhất
+ */
+int max_error(Img a, Img b) {
+    int err = 0;
+    for (int i = 0; i < a.rows; ++i) {
+        const uchar* p = a.ptr<uchar>(i);
+        const uchar* q = b.ptr<uchar>(i);
+        for (int j = 0; j < a.cols * a.channels(); ++j) {
+            err = std::max(err, std::abs(p[j] - q[j]));
+        }
+    }
+    return err;
+}
+
+/**
+ * hàm đo thời gian chạy trung bình của một thao tác
+ * @func: thao tác cần đo
+ * @runs: số lần chạy
+ * @return: thời gian trung bình (ms)
+ */
+template <class Func>
+double time_ms(Func func, int runs) {
+    auto start = cv::getTickCount();
+    for (int k = 0; k < runs; ++k) {
+        func();
+    }
+    return (cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency() / runs;
+}
+
+/**
+ * hàm đo tốc độ của resize so với cv::resize và với scale (biến đổi tổng quát),
+ * sai số chỉ được so với INTER_AREA vì nhân Lanczos của 2 bên khác nhau
+ * kết quả được in ra @out
+ * @img: ảnh dùng để kiểm tra
+ * @xscale, @yscale: tỉ lệ thay đổi
+ * @runs: số lần chạy mỗi cách để lấy thời gian trung bình
+ * @out: luồng xuất kết quả
+ */
+void benchmark_resize(Img img, double xscale, double yscale, int runs, std::ostream& out) {
+    cv::Mat area, lanczos, cv_area, cv_lanczos, warped;
+    double area_ms = time_ms([&] { area = resize(img, xscale, yscale, RESIZE_MD_AREA); }, runs);
+    double lanczos_ms = time_ms([&] { lanczos = resize(img, xscale, yscale, RESIZE_MD_LANCZOS); }, runs);
+    double cv_area_ms = time_ms([&] { cv::resize(img, cv_area, area.size(), 0, 0, cv::INTER_AREA); }, runs);
+    double cv_lanczos_ms = time_ms([&] { cv::resize(img, cv_lanczos, area.size(), 0, 0, cv::INTER_LANCZOS4); }, runs);
+    double warp_ms = time_ms([&] { warped = scale(img, xscale, yscale); }, runs);
+
+    out << "image " << img.cols << "x" << img.rows << " -> " << area.cols << "x" << area.rows << ", " << runs << " runs\n";
+    out << "area: " << area_ms << " ms, cv::resize INTER_AREA " << cv_area_ms << " ms, max error " << max_error(area, cv_area) << "\n";
+    // INTER_LANCZOS4 là nhân 4 thùy không giãn theo tỉ lệ thu nhỏ, khác nhân của Resizer nên chỉ so thời gian, không so sai số
+    out << "lanczos (timing only): " << lanczos_ms << " ms, cv::resize INTER_LANCZOS4 " << cv_lanczos_ms << " ms\n";
+    out << "scale (bilinear warp): " << warp_ms << " ms\n";
 }
@@ -0,0 +1,112 @@
+#include "BufferPool.hpp"
+
+/**
+ * hàm khởi tạo, chỉ được gọi bởi BufferPool::lease
+ * @pool: pool sở hữu khối nhớ
+ * @block: khối nhớ
+ * @bytes: lớp kích thước của khối nhớ
+ * @mat: ảnh dùng dữ liệu trong khối nhớ
+ */
+BufferPool::Lease::Lease(BufferPool* pool, uchar* block, size_t bytes, const cv::Mat& mat)
+    : pool(pool), block(block), bytes(bytes), mat(mat) {}
+
+/**
+ * hàm khởi tạo chuyển quyền sở hữu khối nhớ từ @other
+ */
+BufferPool::Lease::Lease(Lease&& other) : pool(other.pool), block(other.block), bytes(other.bytes), mat(other.mat) {
+    other.block = nullptr;
+    other.mat = cv::Mat();
+}
+
+/**
+ * hàm hủy: trả khối nhớ về pool
+ */
+BufferPool::Lease::~Lease() {
+    if (block) {
+        mat = cv::Mat();
+        pool->give(block, bytes);
+    }
+}
+
+/**
+ * hàm hủy: giải phóng mọi khối nhớ rảnh
+ * các Lease còn sống phải bị hủy trước pool
+ */
+BufferPool::~BufferPool() {
+    clear();
+}
+
+/**
+ * hàm lấy pool dùng chung cho cả chương trình
+ * @return: pool dùng chung
+ */
+BufferPool& BufferPool::global() {
+    static BufferPool pool;
+    return pool;
+}
+
+/**
+ * phương thức mượn vùng nhớ cho một ảnh
+ * nội dung ảnh không được khởi tạo, có thể còn dữ liệu của lần mượn trước
+ * @rows: số dòng
+ * @cols: số cột
+ * @type: kiểu ảnh, ví dụ CV_8UC1
+ * @return: đối tượng giữ khối nhớ và ảnh tương ứng
+ */
+BufferPool::Lease BufferPool::lease(int rows, int cols, int type) {
+    size_t step = cv::alignSize(cols * CV_ELEM_SIZE(type), ALIGN);
+
+    // làm tròn lên lớp kích thước gần nhất, chừa thêm ALIGN byte để căn đầu khối
+    size_t bytes = MIN_BLOCK;
+    while (bytes < step * rows + ALIGN) {
+        bytes *= 2;
+    }
+    uchar* block = take(bytes);
+    cv::Mat mat(rows, cols, type, cv::alignPtr(block, ALIGN), step);
+    return Lease(this, block, bytes, mat);
+}
+
+/**
+ * phương thức lấy số lần pool thực sự cấp phát bộ nhớ, dùng để kiểm tra khi chạy ổn định không còn cấp phát
+ * @return: số lần cấp phát
+ */
+size_t BufferPool::allocations() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return num_allocs;
+}
+
+/**
+ * phương thức giải phóng mọi khối nhớ đang rảnh
+ */
+void BufferPool::clear() {
+    std::lock_guard<std::mutex> lock(mtx);
+    for (auto& cls : free_blocks) {
+        for (auto block : cls.second) {
+            cv::fastFree(block);
+        }
+    }
+    free_blocks.clear();
+}
+
+/**
+ * phương thức lấy một khối rảnh thuộc lớp kích thước @bytes, cấp phát mới nếu không còn
+ */
+uchar* BufferPool::take(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto& blocks = free_blocks[bytes];
+    if (!blocks.empty()) {
+        uchar* block = blocks.back();
+        blocks.pop_back();
+        return block;
+    }
+    ++num_allocs;
+    return (uchar*)cv::fastMalloc(bytes);
+}
+
+/**
+ * phương thức trả khối nhớ về danh sách rảnh của lớp kích thước @bytes
+ */
+void BufferPool::give(uchar* block, size_t bytes) {
+    std::lock_guard<std::mutex> lock(mtx);
+    free_blocks[bytes].push_back(block);
+}
@@ -1,5 +1,13 @@
 #include "Filters.hpp"
+#include "BufferPool.hpp"
+#include "ImageUtils.hpp"
+#include "Convolution.hpp"
+#include <string>
+#include <memory>
+#include <vector>
 #include <cassert>
+#include <algorithm>
+#include <stdexcept>
 #include "opencv2/highgui/highgui.hpp" // cần các hàm cv::imread, cv::imwrite, cv::imshow, cv::waitKey, cv::namedWindow
 #include "opencv2/imgproc/imgproc.hpp" // cần hàm cvtColor
 
@@ -12,29 +20,6 @@ namespace Filters {
 
     typedef const cv::Mat& Img;
 
-    /**
-     * hàm kiểm tra ảnh có phải ảnh xám hay không
-     * @img: ảnh cần kiểm tra
-     * return: true nếu @img là ảnh xám, ngược lại false
-     **/
-    bool is_grayscale(Img img) {
-        // duyệt từng pixel (i, j) trong ảnh
-        for (int i = 0; i < img.rows; ++i) {
-            for (int j = 0; j < img.cols; ++j) {
-                // lấy thông tin 3 kênh màu Red, Blue, Green của ảnh
-                cv::Vec3b pixel = img.at<cv::Vec3b>(i, j);
-                auto R = pixel[2], G = pixel[1], B = pixel[0];
-
-                // ảnh là ảnh xám nếu R = G = B, ngược lại là ảnh màu
-                if (R != G || G != B) {
-                    return false;
-                }
-            }
-        }
-
-        return true;
-    }
-
     /**
      * hàm tạo kernel cho toán tử trung bình
      * @kern_size: kích thước kernel
@@ -67,52 +52,57 @@ namespace Filters {
      * hàm áp dụng toán tử chập
      * @h: ảnh chính
      * @kern: ảnh kernel
-     * @return: ảnh kết quả chập, cùng kích thước với @h, đơn kênh, kiểu uchar
+     * @res: ảnh kết quả chập, cùng kích thước với @h, đơn kênh, kiểu uchar; được tạo lại nếu chưa đúng kích thước,
+     *       có thể trùng hoặc chồng lên vùng nhớ của @h, khi đó kết quả được tính trên ảnh mượn từ pool rồi chép lại
      */
-    cv::Mat convolution(Img h, Img kern) {
-        assert(kern.type()==CV_64DC1);
-        
-        cv::Mat res(h.rows, h.cols, CV_8UC1);
-        int kern_size = kern.rows;
-        assert(kern_size==kern.cols);
-
-        for (int x = 0; x < h.rows; ++x) {
-            for (int y = 0; y < h.cols; ++y) {
-                float gxy = 0;
-                for (int i = -kern_size / 2; i <= kern_size / 2; ++i) {
-                    for (int j = -kern_size / 2; j <= kern_size / 2; ++j) {
-                        if (x - i >= 0 && x - i < h.rows && y - j >= 0 && y - j < h.cols) {
-                            gxy += h.at<uchar>(x - i, y - j) * kern.at<double>(i + kern_size / 2, j + kern_size / 2);
-                        }
-                    }
-                }
-
-                res.at<uchar>(x, y) = cv::saturate_cast<uchar>(gxy);
-            }
+    void convolution(Img h, Img kern, cv::Mat& res) {
+        if (overlaps(res, h)) {
+            auto tmp = BufferPool::global().lease(h.rows, h.cols, CV_8UC1);
+            convolution(h, kern, tmp.mat);
+            tmp.mat.copyTo(res);
+            return;
         }
 
-        return res;
+        convolve(h, kern, res, CV_8U);
     }
 
     /**
      * hàm áp dụng phép lọc trung bình trên ảnh đơn kênh
      * @img: ảnh đầu vào
      * @kern_size: kích thước kernel cho toán tử trung bình
+     * @dst: ảnh kết quả
      */
-    cv::Mat mean_sgc(Img img, int kern_size) {
-        assert(img.channel()==1);
+    void mean_sgc(Img img, int kern_size, cv::Mat& dst) {
+        assert(img.channels()==1);
         auto kern = get_mean_kernel(kern_size);
-        return convolution(img, kern);
+        convolution(img, kern, dst);
     }
 
-    cv::Mat median_sgc(Img img, int kern_size) {
-        assert(img.channel()==1);
-        cv::Mat res(img.rows, img.cols, CV_8UC1);
-        
+    /**
+     * hàm áp dụng phép lọc trung vị trên ảnh đơn kênh
+     * @img: ảnh đầu vào
+     * @kern_size: kích thước kernel
+     * @res: ảnh kết quả, có thể trùng hoặc chồng lên vùng nhớ của @img
+     */
+    void median_sgc(Img img, int kern_size, cv::Mat& res) {
+        assert(img.channels()==1);
+
+        if (overlaps(res, img)) {
+            auto tmp = BufferPool::global().lease(img.rows, img.cols, CV_8UC1);
+            median_sgc(img, kern_size, tmp.mat);
+            tmp.mat.copyTo(res);
+            return;
+        }
+
+        res.create(img.rows, img.cols, CV_8UC1);
+
+        // mảng các điểm lân cận được cấp phát một lần cho cả ảnh
+        std::vector<uchar> locals;
+        locals.reserve(kern_size * kern_size);
         for (int x = 0; x < img.rows; ++x) {
             for (int y = 0; y < img.cols; ++y) {
                 
-                std::vector<uchar> locals;
+                locals.clear();
                 for (int i = -kern_size / 2; i <= kern_size / 2; ++i) {
                     for (int j = -kern_size / 2; j <= kern_size / 2; ++j) {
                         if (x - i >= 0 && x - i < img.rows && y - j >= 0 && y - j < img.cols) {
@@ -125,8 +115,6 @@ namespace Filters {
                 res.at<uchar>(x, y) = locals[locals.size() / 2];
             }
         }
-
-        return res;
     }
 
     /**
@@ -134,77 +122,101 @@ namespace Filters {
      * @img: ảnh đầu vào
      * @kern_size: kích thước nhân
      * @sd: độ lệch chuẩn trong phân phối Gaussian
+     * @dst: ảnh kết quả
      */
-    cv::Mat gaussian_sgc(Img img, int kern_size, double sd) {
-        assert(img.channel()==1);
+    void gaussian_sgc(Img img, int kern_size, double sd, cv::Mat& dst) {
+        assert(img.channels()==1);
         auto kern = get_gaussian_kernel(kern_size, sd);
-        return convolution(img, kern);
+        convolution(img, kern, dst);
     }
 
     /**
-     * hàm áp dụng phép lọc Trung bình trên ảnh đơn kênh
+     * hàm áp dụng một phép lọc đơn kênh lên ảnh xám
+     * ảnh xám 1 kênh được mượn từ pool thay vì cấp phát mới
+     * @img: ảnh đầu vào 3 kênh có R = G = B
+     * @dst: ảnh kết quả đơn kênh
+     * @filter: hàm lọc đơn kênh (ảnh vào, ảnh ra)
+     */
+    template <class Filter>
+    void filter_gray(Img img, cv::Mat& dst, Filter filter) {
+        auto gray = BufferPool::global().lease(img.rows, img.cols, CV_8UC1);
+        cvtColor(img, gray.mat, CV_BGR2GRAY);
+        filter(gray.mat, dst);
+    }
+
+    /**
+     * hàm áp dụng một phép lọc đơn kênh lên từng kênh của ảnh màu
+     * các kênh tách ra và các kênh đã lọc đều được mượn từ pool thay vì cấp phát mới
+     * @img: ảnh đầu vào 3 kênh
+     * @dst: ảnh kết quả 3 kênh
+     * @filter: hàm lọc đơn kênh (ảnh vào, ảnh ra)
+     */
+    template <class Filter>
+    void filter_color(Img img, cv::Mat& dst, Filter filter) {
+        auto& pool = BufferPool::global();
+        BufferPool::Lease planes[] = {
+            pool.lease(img.rows, img.cols, CV_8UC1), pool.lease(img.rows, img.cols, CV_8UC1), pool.lease(img.rows, img.cols, CV_8UC1)
+        };
+        BufferPool::Lease filtered[] = {
+            pool.lease(img.rows, img.cols, CV_8UC1), pool.lease(img.rows, img.cols, CV_8UC1), pool.lease(img.rows, img.cols, CV_8UC1)
+        };
+        cv::Mat bgr[3] = {planes[0].mat, planes[1].mat, planes[2].mat};
+        cv::Mat res[3] = {filtered[0].mat, filtered[1].mat, filtered[2].mat};
+
+        // tách 3 kênh màu ra
+        cv::split(img, bgr);
+        // áp dụng phép lọc trên từng kênh
+        for (int c = 0; c < 3; ++c) {
+            filter(bgr[c], res[c]);
+        }
+        // rồi gộp 3 kênh lại
+        cv::merge(res, 3, dst);
+    }
+
+    /**
+     * hàm áp dụng phép lọc Trung bình trên ảnh xám
      * @img: ảnh đầu vào
      * @kern_size: kích thước nhân
+     * @dst: ảnh kết quả
      */
-    cv::Mat mean_gray(Img img, int kern_size) {
+    void mean_gray(Img img, int kern_size, cv::Mat& dst) {
         if (!is_grayscale(img)) {
             throw std::invalid_argument("mean_gray expected an grayscale image");
         }
-        cv::Mat gray_img;
-        cvtColor(img, gray_img, CV_BGR2GRAY);
-        return mean_sgc(gray_img, kern_size);
+        filter_gray(img, dst, [&](Img src, cv::Mat& out) { mean_sgc(src, kern_size, out); });
     }
 
     /**
      * hàm áp dụng phép lọc Trung bình trên ảnh màu
      * @img: ảnh đầu vào
      * @kern_size: kích thước nhân
+     * @dst: ảnh kết quả
      */
-    cv::Mat mean_color(Img img, int kern_size) {
-        cv::Mat bgr[3];
-        // tách 3 kênh màu ra
-        cv::split(img, bgr);
-        // áp dụng phép lọc trên từng kênh
-        for (auto& chan: bgr) {
-            chan = mean_sgc(chan, kern_size);
-        }
-        cv::Mat res;
-        // rồi gộp 3 kênh lại
-        cv::merge(bgr, 3, res);
-        return res;
+    void mean_color(Img img, int kern_size, cv::Mat& dst) {
+        filter_color(img, dst, [&](Img src, cv::Mat& out) { mean_sgc(src, kern_size, out); });
     }
 
     /**
      * hàm áp dụng phép lọc Trung vị trên ảnh xám
      * @img: ảnh đầu vào
      * @kern_size: kích thước nhân
+     * @dst: ảnh kết quả
      */
-    cv::Mat median_gray(Img img, int kern_size) {
+    void median_gray(Img img, int kern_size, cv::Mat& dst) {
         if (!is_grayscale(img)) {
             throw std::invalid_argument("median_gray expected an grayscale image");
         }
-        cv::Mat gray_img;
-        cvtColor(img, gray_img, CV_BGR2GRAY);
-        return median_sgc(gray_img, kern_size);
+        filter_gray(img, dst, [&](Img src, cv::Mat& out) { median_sgc(src, kern_size, out); });
     }
 
     /**
      * hàm áp dụng phép lọc Trung vị trên ảnh màu
      * @img: ảnh đầu vào
      * @kern_size: kích thước nhân
+     * @dst: ảnh kết quả
      */
-    cv::Mat median_color(Img img, int kern_size) {
-        cv::Mat bgr[3];
-        // tách 3 kênh màu ra
-        cv::split(img, bgr);
-        // áp dụng phép lọc trên từng kênh
-        for (auto& chan: bgr) {
-            chan = median_sgc(chan, kern_size);
-        }
-        cv::Mat res;
-        //  rồi gộp lại
-        cv::merge(bgr, 3, res);
-        return res;
+    void median_color(Img img, int kern_size, cv::Mat& dst) {
+        filter_color(img, dst, [&](Img src, cv::Mat& out) { median_sgc(src, kern_size, out); });
     }
 
     /**
@@ -212,14 +224,13 @@ namespace Filters {
      * @img: ảnh đầu vào
      * @kern_size: kích thước nhân
      * @sd: độ lệch chuẩn trong phân phối Gaussian
+     * @dst: ảnh kết quả
      */
-    cv::Mat gaussian_gray(Img img, int kern_size, double sd) {
+    void gaussian_gray(Img img, int kern_size, double sd, cv::Mat& dst) {
         if (!is_grayscale(img)) {
             throw std::invalid_argument("gaussian_gray expected an grayscale image");
         }
-        cv::Mat gray_img;
-        cvtColor(img, gray_img, CV_BGR2GRAY);
-        return gaussian_sgc(gray_img, kern_size, sd);
+        filter_gray(img, dst, [&](Img src, cv::Mat& out) { gaussian_sgc(src, kern_size, sd, out); });
     }
 
     /**
@@ -227,18 +238,100 @@ namespace Filters {
      * @img: ảnh đầu vào
      * @kern_size: kích thước nhân
      * @sd: độ lệch chuẩn trong phân phối Gaussian
+     * @dst: ảnh kết quả
      */
+    void gaussian_color(Img img, int kern_size, double sd, cv::Mat& dst) {
+        filter_color(img, dst, [&](Img src, cv::Mat& out) { gaussian_sgc(src, kern_size, sd, out); });
+    }
+
+    // các phiên bản trả về ảnh mới
+
+    cv::Mat mean_gray(Img img, int kern_size) {
+        cv::Mat res;
+        mean_gray(img, kern_size, res);
+        return res;
+    }
+
+    cv::Mat mean_color(Img img, int kern_size) {
+        cv::Mat res;
+        mean_color(img, kern_size, res);
+        return res;
+    }
+
+    cv::Mat median_gray(Img img, int kern_size) {
+        cv::Mat res;
+        median_gray(img, kern_size, res);
+        return res;
+    }
+
+    cv::Mat median_color(Img img, int kern_size) {
+        cv::Mat res;
+        median_color(img, kern_size, res);
+        return res;
+    }
+
+    cv::Mat gaussian_gray(Img img, int kern_size, double sd) {
+        cv::Mat res;
+        gaussian_gray(img, kern_size, sd, res);
+        return res;
+    }
+
     cv::Mat gaussian_color(Img img, int kern_size, double sd) {
-        cv::Mat bgr[3];
-        // tách 3 kênh màu ra
-        cv::split(img, bgr);
-        // áp dụng phép lọc trên từng kênh
-        for (auto& chan: bgr) {
-            chan = gaussian_sgc(chan, kern_size, sd);
-        }
         cv::Mat res;
-        // rồi gộp 3 kênh lại
-        cv::merge(bgr, 3, res);
+        gaussian_color(img, kern_size, sd, res);
         return res;
     }
+
+    /**
+     * hàm tạo bước lọc chập theo dòng, các kênh được lọc độc lập như filter_color
+     * @name: tên bước
+     * @kern: kernel của phép lọc
+     * @return: bước STENCIL, kết quả cùng số kênh với ảnh nguồn
+     */
+    Stage conv_stage(const std::string& name, const cv::Mat& kern) {
+        auto conv = std::make_shared<RowConvolver>(kern);
+        int radius = kern.rows / 2;
+        return Stage::makeStencil(name, radius, 0, 0, [conv, radius](const uchar* const* rows, uchar* out, int cols, int cn) {
+            conv->apply(rows + radius - conv->anchor(), cols, cn, out);
+        });
+    }
+
+    void registerStages(Pipeline& pipeline) {
+        pipeline.add("mean", [](const StageArgs& args) {
+            return conv_stage("mean", get_mean_kernel(Pipeline::kern(args, 3)));
+        });
+
+        // trung vị của các pixel lân cận nằm trong ảnh, giống median_sgc
+        pipeline.add("median", [](const StageArgs& args) {
+            int kern = Pipeline::kern(args, 3);
+            return Stage::makeStencil("median", kern / 2, 0, 0, [kern](const uchar* const* rows, uchar* out, int cols, int cn) {
+                std::vector<uchar> locals;
+                locals.reserve(kern * kern);
+                for (int y = 0; y < cols; ++y) {
+                    int j0 = std::max(0, y - kern / 2), j1 = std::min(cols, y + kern / 2 + 1);
+                    for (int c = 0; c < cn; ++c) {
+                        locals.clear();
+                        for (int i = 0; i < kern; ++i) {
+                            if (rows[i]) {
+                                for (int j = j0; j < j1; ++j) {
+                                    locals.push_back(rows[i][j * cn + c]);
+                                }
+                            }
+                        }
+                        std::nth_element(locals.begin(), locals.begin() + locals.size() / 2, locals.end());
+                        out[y * cn + c] = locals[locals.size() / 2];
+                    }
+                }
+            });
+        });
+
+        pipeline.add("gauss", [](const StageArgs& args) {
+            int kern = Pipeline::kern(args, 3);
+            double sd = Pipeline::arg(args, "sd", 0);
+            if (sd == 0) {
+                sd = 0.3 * ((kern - 1) * 0.5 - 1) + 0.8;
+            }
+            return conv_stage("gauss", get_gaussian_kernel(kern, sd));
+        });
+    }
 }
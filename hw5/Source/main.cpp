@@ -58,8 +58,9 @@ namespace Main {
             throw std::invalid_argument("Kernel size expected to be an odd natural number, recieved: " + std::to_string(kern));
         }
 
-        // tính ảnh kết quả
-        auto res = Filters::mean_gray(img, kern);
+        // tính ảnh kết quả vào ảnh cho trước
+        cv::Mat res;
+        Filters::mean_gray(img, kern, res);
 
         // xuất ảnh đầu vào
         show_image(img, "input");
@@ -83,8 +84,9 @@ namespace Main {
             throw std::invalid_argument("Kernel size expected to be an odd natural number, recieved: " + std::to_string(kern));
         }
 
-        // tính ảnh kết quả
-        auto res = Filters::mean_color(img, kern);
+        // tính ảnh kết quả vào ảnh cho trước
+        cv::Mat res;
+        Filters::mean_color(img, kern, res);
 
         // xuất ảnh đầu vào
         show_image(img, "input");
@@ -108,8 +110,9 @@ namespace Main {
             throw std::invalid_argument("Kernel size expected to be an odd natural number, recieved: " + std::to_string(kern));
         }
 
-        // tính ảnh kết quả
-        auto res = Filters::median_gray(img, kern);
+        // tính ảnh kết quả vào ảnh cho trước
+        cv::Mat res;
+        Filters::median_gray(img, kern, res);
 
         // xuất ảnh đầu vào
         show_image(img, "input");
@@ -133,8 +136,9 @@ namespace Main {
             throw std::invalid_argument("Kernel size expected to be an odd natural number, recieved: " + std::to_string(kern));
         }
 
-        // tính ảnh kết quả
-        auto res = Filters::median_color(img, kern);
+        // tính ảnh kết quả vào ảnh cho trước
+        cv::Mat res;
+        Filters::median_color(img, kern, res);
 
         // xuất ảnh đầu vào
         show_image(img, "input");
@@ -165,8 +169,9 @@ namespace Main {
             throw std::invalid_argument("Kernel size expected to be an odd natural number, recieved: " + std::to_string(kern));
         }
 
-        // tính ảnh kết quả
-        auto res = Filters::gaussian_gray(img, kern, sd);
+        // tính ảnh kết quả vào ảnh cho trước
+        cv::Mat res;
+        Filters::gaussian_gray(img, kern, sd, res);
 
         // xuất ảnh đầu vào
         show_image(img, "input");
@@ -197,8 +202,9 @@ namespace Main {
             throw std::invalid_argument("Kernel size expected to be an odd natural number, recieved: " + std::to_string(kern));
         }
 
-        // tính ảnh kết quả
-        auto res = Filters::gaussian_color(img, kern, sd);
+        // tính ảnh kết quả vào ảnh cho trước
+        cv::Mat res;
+        Filters::gaussian_color(img, kern, sd, res);
 
         // xuất ảnh đầu vào
         show_image(img, "input");
@@ -207,6 +213,29 @@ namespace Main {
         show_image(res, "result_" + get_result_info(param));
     }
 
+    /**
+     * hàm xử lý chuỗi các bước lọc từ param parser, ví dụ "gauss:k=5,sd=1 | hqgray | median:k=3"
+     * @param: param parser
+     */
+    void cmd_pipeline(Params param) {
+        ScopedTimer timer(__func__);
+        // lấy ảnh từ param parser
+        auto img = read_img(param);
+
+        // tạo chuỗi xử lý gồm các bước dùng chung và các bước lọc
+        Pipeline pipeline;
+        Filters::registerStages(pipeline);
+
+        // tính ảnh kết quả
+        auto res = pipeline.parse(param.get<std::string>("pipeline")).run(img);
+
+        // xuất ảnh đầu vào
+        show_image(img, "input");
+
+        // xuất ảnh kết quả
+        show_image(res, "result_pipeline");
+    }
+
     typedef void (*cmd_func)(const cv::CommandLineParser&);
 
     // bảng ánh xạ từ chuỗi mã lệnh tới hàm xử lý tương ứng dựa vào param parser
@@ -217,7 +246,8 @@ namespace Main {
         {"meg", cmd_meg},
         {"mec", cmd_mec},
         {"gg", cmd_gg},
-        {"gc", cmd_gc}
+        {"gc", cmd_gc},
+        {"pipeline", cmd_pipeline}
     };
     
     std::string get_result_info(Params param) {
@@ -244,6 +274,7 @@ namespace Main {
             "{mec   || median filter on color image}"
             "{gg    || Gaussian filter on grayscale image}"
             "{gc    || Gaussian filter on color image}"
+            "{pipeline || chain of steps separated by vertical bars, e.g. gauss:k=5,sd=1, hqgray, median:k=3}"
             "{kern  |3| kernel size (must be an odd natural number}"
             "{sd    |0| standard deviation of the Gaussian distribution in Gaussian filter}"
             "{help  || show help}"
@@ -0,0 +1,56 @@
+#pragma once
+#include <map>
+#include <mutex>
+#include <vector>
+#include "opencv2/core/core.hpp"
+
+/**
+ * lớp quản lý vùng nhớ tái sử dụng cho các ảnh trung gian
+ * vùng nhớ được chia theo lớp kích thước là lũy thừa của 2 (tối thiểu MIN_BLOCK byte); khi một ảnh trung gian
+ * không còn dùng, khối nhớ của nó được trả về danh sách rảnh của lớp tương ứng và được cấp lại cho lần mượn sau,
+ * nên khi xử lý liên tục nhiều ảnh cùng kích thước thì không còn cấp phát mới
+ * mỗi dòng của ảnh được căn theo ALIGN byte để các vòng lặp có thể dùng lệnh SIMD nạp căn lề
+ */
+class BufferPool {
+public:
+    /**
+     * lớp giữ một khối nhớ mượn từ pool, khối nhớ được trả lại khi đối tượng bị hủy
+     * @mat chỉ dùng chung dữ liệu với khối nhớ, không được giữ lại sau khi Lease bị hủy (cần clone() nếu muốn giữ)
+     */
+    class Lease {
+        BufferPool* pool;
+        uchar* block;
+        size_t bytes;
+    public:
+        cv::Mat mat;
+
+        Lease(BufferPool*, uchar*, size_t, const cv::Mat&);
+        Lease(Lease&&);
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease();
+    };
+
+    static const size_t MIN_BLOCK = 4096;
+    static const int ALIGN = 64;
+
+    ~BufferPool();
+
+    // pool dùng chung cho cả chương trình
+    static BufferPool& global();
+
+    Lease lease(int, int, int);
+    size_t allocations();
+    void clear();
+private:
+    // danh sách khối rảnh của mỗi lớp kích thước
+    std::map<size_t, std::vector<uchar*>> free_blocks;
+
+    // số lần thực sự cấp phát bộ nhớ
+    size_t num_allocs = 0;
+
+    std::mutex mtx;
+
+    uchar* take(size_t);
+    void give(uchar*, size_t);
+};
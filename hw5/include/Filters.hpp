@@ -1,5 +1,6 @@
 #pragma once
 #include "opencv2/core/core.hpp"
+#include "Pipeline.hpp"
 
 namespace Filters {
     typedef const cv::Mat& Img;
@@ -9,4 +10,17 @@ namespace Filters {
     cv::Mat median_color(Img, int);
     cv::Mat gaussian_gray(Img, int, double);
     cv::Mat gaussian_color(Img, int, double);
+
+    // các phiên bản ghi kết quả vào @dst có sẵn: nếu @dst đã đúng kích thước và kiểu thì không cấp phát lại,
+    // ảnh trung gian được mượn từ BufferPool::global()
+    void mean_gray(Img, int, cv::Mat&);
+    void mean_color(Img, int, cv::Mat&);
+    void median_gray(Img, int, cv::Mat&);
+    void median_color(Img, int, cv::Mat&);
+    void gaussian_gray(Img, int, double, cv::Mat&);
+    void gaussian_color(Img, int, double, cv::Mat&);
+
+    // đăng ký các bước lọc cho chuỗi xử lý: mean:k=, median:k=, gauss:k=,sd=
+    // các bước chạy theo dòng (STENCIL), mỗi kênh được lọc độc lập nên kết quả giữ nguyên số kênh của ảnh nguồn
+    void registerStages(Pipeline&);
 }
@@ -1,37 +1,40 @@
 #include "EdgeDetect.hpp"
+#include "Convolution.hpp"
 #include "opencv2/core.hpp"
 #include "opencv2/imgproc/imgproc.hpp" // cần hàm cvtColor
+#include "opencv2/core/utility.hpp" // cần hàm cv::parallel_for_
+#include <cmath>
+#include <algorithm>
+#include <memory>
+#include <vector>
 #include <iostream>
+#include <stdexcept>
+#include "ImageUtils.hpp"
+#ifdef BDBG
 #include "/home/duongbao/code-hub/logger.hpp"
+#endif
 
 namespace EdgeDetect {
     const double PI = 3.14159265359;
+    /**
+     * hàm áp dụng toán tử chập vào ảnh cho trước
+     * @h: ảnh chính
+     * @kern: ảnh kernel
+     * @res: ảnh kết quả chập, cùng kích thước với @h, đơn kênh, kiểu double; được tạo lại nếu chưa đúng kích thước và kiểu
+     */
+    void convolution(Img h, Img kern, cv::Mat& res) {
+        convolve(h, kern, res);
+    }
+
     /**
      * hàm áp dụng toán tử chập
      * @h: ảnh chính
      * @kern: ảnh kernel
-     * @return: ảnh kết quả chập, cùng kích thước với @h, đơn kênh, kiểu uchar
+     * @return: ảnh kết quả chập, cùng kích thước với @h, đơn kênh, kiểu double
      */
     cv::Mat convolution(Img h, Img kern) {
-        assert(kern.type()==CV_64FC1);
-
-        cv::Mat res(h.rows, h.cols, CV_64FC1);
-        int kern_size = kern.rows;
-        assert(kern_size==kern.cols);
-
-        for (int x = 0; x + kern_size <= h.rows; ++x) {
-            for (int y = 0; y + kern_size <= h.cols; ++y) {
-                double gxy = 0;
-                for (int i = 0; i < kern_size; ++i) {
-                    for (int j = 0; j < kern_size; ++j) {
-                        gxy += h.at<uchar>(x + i, y + j) * kern.at<double>(kern_size - 1 - i, kern_size - 1 - j);
-                    }
-                }
-
-                res.at<double>(x, y) = gxy;
-            }
-        }
-
+        cv::Mat res;
+        convolution(h, kern, res);
         return res;
     }
 
@@ -43,15 +46,48 @@ namespace EdgeDetect {
         }
     }
     
-    cv::Mat get_grad(Img img, const std::pair<cv::Mat, cv::Mat>& mask) {
-        auto gx = convolution(img, mask.first);
-        auto gy = convolution(img, mask.second);
-        auto res = img.clone();
-        for (int i = 0; i < res.rows; ++i) {
-            for (int j = 0; j < res.cols; ++j) {
-                res.at<uchar>(i, j) = cv::saturate_cast<uchar>(std::sqrt(std::pow(gx.at<double>(i, j), 2) + std::pow(gy.at<double>(i, j), 2)));
-            }
+    /**
+     * hàm tính độ lớn gradient vào ảnh cho trước
+     * 2 đạo hàm được chập theo từng dòng vào 2 dòng đệm của mỗi luồng thay vì 2 ảnh double cả khung,
+     * cùng RowConvolver với convolve nên kết quả trùng khớp từng bit
+     * @h: ảnh xám đơn kênh, kiểu uchar
+     * @mask: cặp kernel đạo hàm theo 2 trục, cùng kích thước
+     * @res: ảnh kết quả cùng kích thước với @h, kiểu uchar; được tạo lại nếu chưa đúng kích thước, có thể trùng với @h
+     */
+    void get_grad(Img h, const std::pair<cv::Mat, cv::Mat>& mask, cv::Mat& res) {
+        if (h.type() != CV_8UC1) {
+            throw std::runtime_error("Anh hoac kernel khong hop le cho phep chap");
         }
+        RowConvolver gx(mask.first), gy(mask.second);
+
+        // mỗi dòng kết quả đọc nhiều dòng nguồn nên ảnh kết quả chồng lên ảnh nguồn thì tính trên bản sao
+        cv::Mat img = overlaps(h, res) ? h.clone() : h;
+        res.create(img.size(), CV_8UC1);
+
+        cv::parallel_for_(cv::Range(0, img.rows), [&](const cv::Range& range) {
+            std::vector<const uchar*> rows(std::max(gx.size(), gy.size()));
+            std::vector<double> dx(img.cols), dy(img.cols);
+            auto gather = [&](const RowConvolver& conv, int x) {
+                for (int i = 0; i < conv.size(); ++i) {
+                    int sx = x + i - conv.anchor();
+                    rows[i] = sx >= 0 && sx < img.rows ? img.ptr<uchar>(sx) : nullptr;
+                }
+                return rows.data();
+            };
+            for (int x = range.start; x < range.end; ++x) {
+                gx.apply(gather(gx, x), img.cols, 1, dx.data());
+                gy.apply(gather(gy, x), img.cols, 1, dy.data());
+                uchar* out = res.ptr<uchar>(x);
+                for (int j = 0; j < img.cols; ++j) {
+                    out[j] = cv::saturate_cast<uchar>(std::sqrt(std::pow(dx[j], 2) + std::pow(dy[j], 2)));
+                }
+            }
+        });
+    }
+
+    cv::Mat get_grad(Img img, const std::pair<cv::Mat, cv::Mat>& mask) {
+        cv::Mat res;
+        get_grad(img, mask, res);
         return res;
     }
 
@@ -80,6 +116,22 @@ namespace EdgeDetect {
         return {gx, gy};
     }
 
+    void cmd_gra_sobel(Img img, cv::Mat& res) {
+        get_grad(img, get_sobel_kern(), res);
+    }
+
+    void cmd_gra_prewitt(Img img, cv::Mat& res) {
+        get_grad(img, get_prewitt_kern(), res);
+    }
+
+    void cmd_gra_scharr(Img img, cv::Mat& res) {
+        get_grad(img, get_scharr_kern(), res);
+    }
+
+    void cmd_gra_roberts(Img img, cv::Mat& res) {
+        get_grad(img, get_robert_kern(), res);
+    }
+
     cv::Mat cmd_gra_sobel(Img img) {
         return get_grad(img, get_sobel_kern());
     }
@@ -101,6 +153,10 @@ namespace EdgeDetect {
         return mask;
     }
     
+    void cmd_laplacian(Img img, cv::Mat& res) {
+        convolution(img, get_laplacian_mask(), res);
+    }
+
     cv::Mat cmd_laplacian(Img img) {
         return convolution(img, get_laplacian_mask());
     }
@@ -118,7 +174,65 @@ namespace EdgeDetect {
         return kern;
     }
     
+    void cmd_log(Img img, int kern_size, double sd, cv::Mat& res) {
+        convolution(img, get_log_mask(kern_size, sd), res);
+    }
+
     cv::Mat cmd_log(Img img, int kern_size, double sd) {
         return convolution(img, get_log_mask(kern_size, sd));
     }
+
+    /**
+     * hàm tạo bước dò cạnh theo độ lớn gradient, chạy theo dòng
+     * @name: tên bước
+     * @mask: cặp kernel đạo hàm theo 2 trục
+     * @return: bước STENCIL nhận ảnh xám đơn kênh, kết quả giống get_grad
+     */
+    Stage grad_stage(const std::string& name, const std::pair<cv::Mat, cv::Mat>& mask) {
+        auto gx = std::make_shared<RowConvolver>(mask.first);
+        auto gy = std::make_shared<RowConvolver>(mask.second);
+        int radius = mask.first.rows / 2;
+        return Stage::makeStencil(name, radius, 1, 1, [gx, gy, radius](const uchar* const* rows, uchar* out, int cols, int) {
+            // 2 dòng đạo hàm của mỗi luồng, dùng lại cho mọi dòng
+            static thread_local std::vector<double> dx, dy;
+            dx.resize(cols);
+            dy.resize(cols);
+            gx->apply(rows + radius - gx->anchor(), cols, 1, dx.data());
+            gy->apply(rows + radius - gy->anchor(), cols, 1, dy.data());
+            for (int j = 0; j < cols; ++j) {
+                out[j] = cv::saturate_cast<uchar>(std::sqrt(std::pow(dx[j], 2) + std::pow(dy[j], 2)));
+            }
+        });
+    }
+
+    /**
+     * hàm tạo bước chập theo dòng
+     * @name: tên bước
+     * @kern: kernel
+     * @return: bước STENCIL nhận ảnh xám đơn kênh, kết quả được làm tròn và chặn vào [0, 255]
+     */
+    Stage conv_stage(const std::string& name, const cv::Mat& kern) {
+        auto conv = std::make_shared<RowConvolver>(kern);
+        int radius = kern.rows / 2;
+        return Stage::makeStencil(name, radius, 1, 1, [conv, radius](const uchar* const* rows, uchar* out, int cols, int) {
+            conv->apply(rows + radius - conv->anchor(), cols, 1, out);
+        });
+    }
+
+    void registerStages(Pipeline& pipeline) {
+        pipeline.add("gra-sobel", [](const StageArgs&) { return grad_stage("gra-sobel", get_sobel_kern()); });
+        pipeline.add("gra-prewitt", [](const StageArgs&) { return grad_stage("gra-prewitt", get_prewitt_kern()); });
+        pipeline.add("gra-scharr", [](const StageArgs&) { return grad_stage("gra-scharr", get_scharr_kern()); });
+        pipeline.add("gra-roberts", [](const StageArgs&) { return grad_stage("gra-roberts", get_robert_kern()); });
+        pipeline.add("laplacian", [](const StageArgs&) { return conv_stage("laplacian", get_laplacian_mask()); });
+
+        pipeline.add("log", [](const StageArgs& args) {
+            int kern = Pipeline::kern(args, 5);
+            double sd = Pipeline::arg(args, "sd", 0.8);
+            if (sd == 0) {
+                sd = 0.3 * ((kern - 1) * 0.5 - 1) + 0.8;
+            }
+            return conv_stage("log", get_log_mask(kern, sd));
+        });
+    }
 }
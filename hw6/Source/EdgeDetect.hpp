@@ -1,5 +1,6 @@
 #pragma once
 #include "opencv2/core.hpp"
+#include "Pipeline.hpp"
 
 typedef const cv::Mat& Img;
 namespace EdgeDetect {
@@ -9,4 +10,17 @@ namespace EdgeDetect {
     cv::Mat cmd_gra_roberts(Img);
     cv::Mat cmd_laplacian(Img);
     cv::Mat cmd_log(Img, int, double);
+
+    // các phiên bản ghi vào ảnh cho trước, ảnh được tạo lại nếu chưa đúng kích thước và kiểu nên gọi lặp lại không cấp phát thêm
+    void cmd_gra_sobel(Img, cv::Mat&);
+    void cmd_gra_prewitt(Img, cv::Mat&);
+    void cmd_gra_scharr(Img, cv::Mat&);
+    void cmd_gra_roberts(Img, cv::Mat&);
+    void cmd_laplacian(Img, cv::Mat&);
+    void cmd_log(Img, int, double, cv::Mat&);
+
+    // đăng ký các bước dò cạnh cho chuỗi xử lý: gra-sobel, gra-prewitt, gra-scharr, gra-roberts, laplacian, log:k=,sd=
+    // các bước chạy theo dòng (STENCIL), ảnh 3 kênh được chuyển sang ảnh xám trong cùng lượt duyệt,
+    // kết quả luôn là ảnh xám đơn kênh kiểu uchar
+    void registerStages(Pipeline&);
 }
@@ -1,6 +1,7 @@
 #include <string>                      // cần kiểu std::string
 #include <iostream>                    // cần std::cerr, std::endl
 #include "EdgeDetect.hpp"                     // định nghĩa các hàm chức năng xử lý trên ảnh
+#include "Filters.hpp"                     // các bước lọc của hw5 dùng trong chuỗi xử lý
 #include "ScopedTimer.hpp"
 #include <map>
 #include "opencv2/highgui/highgui.hpp" // cần các hàm cv::imread, cv::imwrite, cv::imshow, cv::waitKey, cv::namedWindow
@@ -41,13 +42,15 @@ namespace Main {
      */
     void show_help(Params params) {
         params.printMessage();
+        std::cout << "Example: 1612840_Lab05 image.png --pipeline=\"gauss:k=5,sd=1 | hqgray | gra-sobel\"" << std::endl;
     }
 
     void cmd_gra_sobel(Params param) {
         auto img = read_img(param);
         cvtColor(img, img, ::CV_BGR2GRAY);
 
-        auto res = EdgeDetect::cmd_gra_sobel(img);
+        cv::Mat res;
+        EdgeDetect::cmd_gra_sobel(img, res);
 
         show_image(img, "input");
 
@@ -58,7 +61,8 @@ namespace Main {
         auto img = read_img(param);
         cvtColor(img, img, ::CV_BGR2GRAY);
 
-        auto res = EdgeDetect::cmd_gra_prewitt(img);
+        cv::Mat res;
+        EdgeDetect::cmd_gra_prewitt(img, res);
 
         show_image(img, "input");
 
@@ -69,7 +73,8 @@ namespace Main {
         auto img = read_img(param);
         cvtColor(img, img, ::CV_BGR2GRAY);
 
-        auto res = EdgeDetect::cmd_gra_scharr(img);
+        cv::Mat res;
+        EdgeDetect::cmd_gra_scharr(img, res);
 
         show_image(img, "input");
 
@@ -80,7 +85,8 @@ namespace Main {
         auto img = read_img(param);
         cvtColor(img, img, ::CV_BGR2GRAY);
 
-        auto res = EdgeDetect::cmd_gra_roberts(img);
+        cv::Mat res;
+        EdgeDetect::cmd_gra_roberts(img, res);
 
         show_image(img, "input");
 
@@ -91,7 +97,8 @@ namespace Main {
         auto img = read_img(param);
         cvtColor(img, img, ::CV_BGR2GRAY);
 
-        auto res = EdgeDetect::cmd_laplacian(img);
+        cv::Mat res;
+        EdgeDetect::cmd_laplacian(img, res);
 
         show_image(img, "input");
 
@@ -107,13 +114,34 @@ namespace Main {
         if (sd == 0) {
             sd = 0.3 * ((kern - 1) * 0.5 - 1) + 0.8;
         }
-        auto res = EdgeDetect::cmd_log(img, kern, sd);
+        cv::Mat res;
+        EdgeDetect::cmd_log(img, kern, sd, res);
 
         show_image(img, "input");
 
         show_image(res, "result_" + get_result_info(param));
     }
     
+    /**
+     * hàm xử lý chuỗi các bước từ param parser, ví dụ "gauss:k=5,sd=1 | hqgray | gra-sobel"
+     * các bước lọc của hw5 và các bước dò cạnh chạy nối tiếp trong cùng tiến trình, không ghi ảnh trung gian
+     * @param: param parser
+     */
+    void cmd_pipeline(Params param) {
+        ScopedTimer timer(__func__);
+        auto img = read_img(param);
+
+        Pipeline pipeline;
+        Filters::registerStages(pipeline);
+        EdgeDetect::registerStages(pipeline);
+
+        auto res = pipeline.parse(param.get<std::string>("pipeline")).run(img);
+
+        show_image(img, "input");
+
+        show_image(res, "result_" + get_result_info(param));
+    }
+
     typedef void (*cmd_func)(const cv::CommandLineParser&);
 
     // bảng ánh xạ từ chuỗi mã lệnh tới hàm xử lý tương ứng dựa vào param parser
@@ -125,6 +153,8 @@ namespace Main {
         {"gra-roberts", cmd_gra_roberts},
         {"laplacian", cmd_laplacian},
         {"log", cmd_log},
+        {"pipeline", cmd_pipeline},
+        {"help", show_help},
     };
     
     std::string get_result_info(Params param) {
@@ -132,7 +162,9 @@ namespace Main {
                     return param.has(cmd.first);
                     })->first;
         std::replace(res.begin(), res.end(), '.', '_');
+#ifdef BDBG
         dtell(res);
+#endif
         return res;
 //             + "_kern-" + std::to_string(param.get<int>("kern"))
 //             + "_sd-" + std::to_string(param.get<double>("sd"));
@@ -155,6 +187,7 @@ namespace Main {
             "{laplacian    || Laplacian mask}"
             "{log    || Log mask}"
             "{canny  || Edge detection with Canny}"
+            "{pipeline || chain of steps separated by vertical bars, see the example below}"
             "{kern |5| kernel size for LoG filter}"
             "{sd |0.8| Standard deviation for LoG filter}"
             "{thresh |0| Threshold for Canny edge detect}"